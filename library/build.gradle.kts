@@ -70,6 +70,7 @@ kotlin {
             dependsOn(commonMain)
             dependencies {
                 implementation(project(":pag4j"))
+                implementation(libs.kotlinx.coroutines)
             }
         }
 
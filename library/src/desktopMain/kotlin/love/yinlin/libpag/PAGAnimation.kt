@@ -14,6 +14,7 @@ import androidx.compose.ui.graphics.painter.BitmapPainter
 import androidx.compose.ui.graphics.painter.Painter
 import androidx.compose.ui.graphics.toComposeImageBitmap
 import androidx.compose.ui.unit.IntSize
+import kotlinx.coroutines.future.await
 import org.jetbrains.skia.ColorAlphaType
 import org.jetbrains.skia.ColorSpace
 import org.jetbrains.skia.ColorType
@@ -78,7 +79,8 @@ actual fun rememberPAGPainter(
 
     LaunchedEffect(data) {
         if (data == null) return@LaunchedEffect
-        PAGFile.Load(data)?.let { pagFile ->
+        // Parses on a native loader thread, leaving the composition free to continue.
+        PAGFile.LoadAsync(data).await()?.let { pagFile ->
             player.composition = pagFile
             val size = if (size == IntSize.Zero) IntSize(pagFile.width(), pagFile.height()) else size
             imageInfo = ImageInfo(size.width, size.height, ColorType.RGBA_8888, ColorAlphaType.PREMUL, ColorSpace.sRGB)
@@ -0,0 +1,119 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JAssetResidency.h"
+#include <algorithm>
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+namespace pag {
+void JAssetResidency::setConfig(bool enabled, int64_t newMargin) {
+  _enabled = enabled;
+  margin = std::max<int64_t>(0, newMargin);
+  composition.reset();
+  assets.clear();
+  assetIndex = nullptr;
+  residentAssets.clear();
+}
+
+void JAssetResidency::collectAssets(std::shared_ptr<PAGComposition> root) {
+  assets.clear();
+  residentAssets.clear();
+  std::vector<JIntervalIndex::Interval> intervals = {};
+  for (auto& span : CollectAssetSpans(root)) {
+    intervals.push_back({span.startTime, span.endTime, static_cast<int>(assets.size())});
+    assets.push_back({span, false});
+  }
+  assetIndex.reset(new JIntervalIndex(std::move(intervals)));
+}
+
+bool JAssetResidency::beforeFlush(PAGPlayer* player) {
+  auto root = player->getComposition();
+  if (root == nullptr) {
+    return false;
+  }
+  auto version = ContentVersion(root);
+  if (root != composition.lock() || version != assetsVersion) {
+    composition = root;
+    assetsVersion = version;
+    collectAssets(root);
+  }
+  auto duration = player->duration();
+  if (assets.empty() || duration <= 0) {
+    return false;
+  }
+  auto now = static_cast<int64_t>(player->getProgress() * static_cast<double>(duration));
+  std::vector<int> visibleAssets = {};
+  assetIndex->query(now, &visibleAssets);
+  for (auto index : visibleAssets) {
+    if (!assets[index].resident) {
+      assets[index].resident = true;
+      residentAssets.push_back(index);
+    }
+  }
+  int64_t residentBytes = 0;
+  int64_t staleBytes = 0;
+  for (auto index : residentAssets) {
+    auto& span = assets[index].span;
+    residentBytes += span.bytes;
+    auto distance = now < span.startTime ? span.startTime - now : now - span.endTime;
+    if (distance > margin) {
+      staleBytes += span.bytes;
+    }
+  }
+  // Freeing the caches drops the visible assets as well, which then have to be decoded again. It is
+  // only worth it once the stale assets hold at least half of the decoded memory.
+  if (staleBytes == 0 || staleBytes * 2 < residentBytes) {
+    return false;
+  }
+  auto surface = player->getSurface();
+  if (surface == nullptr) {
+    return false;
+  }
+  {
+    PAG4J_TRACE_EVENT("pag", "PAGSurface::freeCache");
+    surface->freeCache();
+  }
+  for (auto index : residentAssets) {
+    assets[index].resident = false;
+  }
+  for (auto index : visibleAssets) {
+    assets[index].resident = true;
+  }
+  residentAssets = std::move(visibleAssets);
+  _evictionCount++;
+  return true;
+}
+
+JAssetResidency::Stats JAssetResidency::getStats(ID fileID) const {
+  Stats stats = {};
+  for (auto& asset : assets) {
+    if (fileID != 0 && asset.span.fileID != fileID) {
+      continue;
+    }
+    stats.totalBytes += asset.span.bytes;
+    stats.totalCount++;
+    if (asset.resident) {
+      stats.residentBytes += asset.span.bytes;
+      stats.residentCount++;
+    }
+  }
+  return stats;
+}
+}  // namespace pag
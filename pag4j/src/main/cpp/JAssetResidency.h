@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "JAssetSpans.h"
+#include "JIntervalIndex.h"
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * Tracks which embedded assets of the composition of a PAGPlayer have been decoded, and frees the
+ * caches of its surface once most of the decoded memory belongs to assets the playhead has left by
+ * more than a margin. libpag decodes an asset the first time it is drawn and keeps it until its
+ * caches are freed, so a long template would otherwise keep the assets of every scene it has
+ * played. The compressed bytes stay in the file, the assets are decoded again when they become
+ * visible the next time.
+ */
+class JAssetResidency {
+ public:
+  struct Stats {
+    int64_t residentBytes = 0;
+    int64_t totalBytes = 0;
+    int64_t residentCount = 0;
+    int64_t totalCount = 0;
+  };
+
+  bool enabled() const {
+    return _enabled;
+  }
+
+  /**
+   * Enables or disables the eviction. The margin is the time in microseconds an asset is kept after
+   * the playhead has left its time range, or before it enters it when playing backwards.
+   */
+  void setConfig(bool enabled, int64_t margin);
+
+  /**
+   * Called before every flush of the player, must run on the thread that renders it. Returns true
+   * if the caches were freed, in which case the flush has to redraw the frame.
+   */
+  bool beforeFlush(PAGPlayer* player);
+
+  /**
+   * Returns the assets whose nearest PAGFile has the uniqueID, or all the assets of the composition
+   * if the ID is 0.
+   */
+  Stats getStats(ID fileID) const;
+
+  int64_t evictionCount() const {
+    return _evictionCount;
+  }
+
+ private:
+  struct Asset {
+    AssetSpan span = {};
+    bool resident = false;
+  };
+
+  bool _enabled = false;
+  int64_t margin = 0;
+  std::weak_ptr<PAGComposition> composition;
+  uint64_t assetsVersion = 0;
+  std::vector<Asset> assets = {};
+  std::unique_ptr<JIntervalIndex> assetIndex = nullptr;
+  // The indices of the resident assets, so that a flush only visits them and the visible ones.
+  std::vector<int> residentAssets = {};
+  int64_t _evictionCount = 0;
+
+  void collectAssets(std::shared_ptr<PAGComposition> root);
+};
+}  // namespace pag
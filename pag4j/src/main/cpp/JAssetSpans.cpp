@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JAssetSpans.h"
+#include <algorithm>
+#include "JTrace.h"
+
+namespace pag {
+static void CollectAssetLayers(std::shared_ptr<PAGComposition> composition, ID fileID,
+                               std::vector<AssetSpan>* spans) {
+  if (composition->isPAGFile()) {
+    fileID = composition->uniqueID();
+  }
+  for (int i = 0; i < composition->numChildren(); i++) {
+    auto layer = composition->getLayerAt(i);
+    if (layer == nullptr || layer->excludedFromTimeline()) {
+      continue;
+    }
+    auto isAsset = layer->layerType() == LayerType::Image;
+    if (layer->layerType() == LayerType::PreCompose) {
+      auto child = std::static_pointer_cast<PAGComposition>(layer);
+      // Video and bitmap sequences are exposed as compositions without child layers.
+      if (child->numChildren() > 0) {
+        CollectAssetLayers(child, fileID, spans);
+        continue;
+      }
+      isAsset = true;
+    }
+    if (!isAsset) {
+      continue;
+    }
+    auto bounds = layer->getBounds();
+    AssetSpan span = {};
+    span.fileID = fileID;
+    span.startTime = layer->localTimeToGlobal(layer->startTime());
+    span.endTime = layer->localTimeToGlobal(layer->startTime() + layer->duration());
+    span.bytes = static_cast<int64_t>(std::max(0.0f, bounds.width())) *
+                 static_cast<int64_t>(std::max(0.0f, bounds.height())) * 4;
+    spans->push_back(span);
+  }
+}
+
+std::vector<AssetSpan> CollectAssetSpans(std::shared_ptr<PAGComposition> root) {
+  PAG4J_TRACE_EVENT("pag", "CollectAssetSpans");
+  std::vector<AssetSpan> spans = {};
+  if (root == nullptr) {
+    return spans;
+  }
+  CollectAssetLayers(root, 0, &spans);
+  std::sort(spans.begin(), spans.end(), [](const AssetSpan& a, const AssetSpan& b) {
+    return a.startTime < b.startTime;
+  });
+  return spans;
+}
+}  // namespace pag
@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * An embedded asset of a composition: an image layer or a sequence composition (video or bitmap
+ * sequences, which have no child layers), with the time range it is visible in.
+ */
+struct AssetSpan {
+  // The uniqueID of the nearest PAGFile containing the asset, 0 if there is none.
+  ID fileID = 0;
+  // The time range on the timeline of the root composition, in microseconds.
+  int64_t startTime = 0;
+  int64_t endTime = 0;
+  // The estimated decoded size, 4 bytes per pixel of the layer bounds.
+  int64_t bytes = 0;
+};
+
+/**
+ * Returns the assets of the composition and its descendants, sorted by their start times. Layers
+ * excluded from the timeline are skipped.
+ */
+std::vector<AssetSpan> CollectAssetSpans(std::shared_ptr<PAGComposition> root);
+}  // namespace pag
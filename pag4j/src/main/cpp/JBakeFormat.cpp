@@ -0,0 +1,442 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JBakeFormat.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "JTrace.h"
+#ifdef PAG4J_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace pag {
+static constexpr uint32_t BakeMagic = 0x42474150;  // "PAGB" in little endian.
+static constexpr uint32_t BakeVersion = 2;
+static constexpr uint32_t CompressionNone = 0;
+static constexpr uint32_t CompressionDeflate = 1;
+// The number of frames the layer costs are averaged over.
+static constexpr int64_t MaxCostSamples = 16;
+// Favors speed over size, like the PNG export.
+static constexpr int BakeCompressionLevel = 3;
+// The largest frame a sidecar may declare, 8192 x 8192 RGBA pixels.
+static constexpr uint64_t MaxFrameSize = 256u * 1024 * 1024;
+// Deflate never expands data by more than this ratio, which bounds the frame size a compressed
+// entry can decode to.
+static constexpr uint64_t MaxDeflateRatio = 1032;
+
+// The sidecar is written in the byte order of the machine, it is meant to be baked and played on
+// the same platform.
+struct BakeHeader {
+  uint32_t magic = BakeMagic;
+  uint32_t version = BakeVersion;
+  int32_t width = 0;
+  int32_t height = 0;
+  float frameRate = 0;
+  uint32_t compression = CompressionNone;
+  int64_t numFrames = 0;
+  // The frames hold the child layers [0, bakedLayers) of the numLayers of the root composition.
+  int32_t numLayers = 0;
+  int32_t bakedLayers = 0;
+};
+
+// fseek() and ftell() take a long, which is 32 bits on Windows and ends at 2 GB.
+static bool SeekFile(FILE* file, uint64_t offset, int origin) {
+#ifdef _WIN32
+  return _fseeki64(file, static_cast<__int64>(offset), origin) == 0;
+#else
+  return fseeko(file, static_cast<off_t>(offset), origin) == 0;
+#endif
+}
+
+static int64_t TellFile(FILE* file) {
+#ifdef _WIN32
+  return _ftelli64(file);
+#else
+  return static_cast<int64_t>(ftello(file));
+#endif
+}
+
+static int64_t GetTimeMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The same frame mapping as CountFrames() and FrameToProgress() of the bindings, which this file
+// can not include since it is linked into pag4j-bake as well.
+static int64_t BakeFrameCount(std::shared_ptr<PAGComposition> composition) {
+  auto frames = std::floor(composition->duration() * composition->frameRate() / 1000000.0);
+  return std::max<int64_t>(1, static_cast<int64_t>(frames));
+}
+
+static double BakeFrameToProgress(int64_t frame, int64_t totalFrames) {
+  if (totalFrames <= 1 || frame <= 0) {
+    return 0;
+  }
+  if (frame >= totalFrames - 1) {
+    return 1;
+  }
+  return (static_cast<double>(frame) + 0.1) / static_cast<double>(totalFrames);
+}
+
+static bool HasLiveLayers(std::shared_ptr<PAGLayer> layer) {
+  auto type = layer->layerType();
+  if ((type == LayerType::Text || type == LayerType::Image) && layer->editableIndex() >= 0) {
+    return true;
+  }
+  if (type != LayerType::PreCompose) {
+    return false;
+  }
+  auto composition = std::static_pointer_cast<PAGComposition>(layer);
+  for (int i = 0; i < composition->numChildren(); i++) {
+    auto child = composition->getLayerAt(i);
+    if (child != nullptr && HasLiveLayers(child)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int64_t TimeFlush(PAGPlayer* player) {
+  auto startTime = GetTimeMicros();
+  player->flush();
+  return GetTimeMicros() - startTime;
+}
+
+/**
+ * Measures every child layer by rendering the sampled frames with and without it. Both renders
+ * follow a change of the layer tree, so they run with the same caches.
+ */
+static void MeasureLayerCosts(PAGPlayer* player, std::shared_ptr<PAGFile> file,
+                              BakeReport* report) {
+  PAG4J_TRACE_EVENT("pag", "BakeFile::measure");
+  auto numSamples = std::min(report->numFrames, MaxCostSamples);
+  std::vector<std::shared_ptr<PAGLayer>> layers = {};
+  for (int i = 0; i < file->numChildren(); i++) {
+    auto layer = file->getLayerAt(i);
+    if (layer == nullptr) {
+      continue;
+    }
+    BakeLayerCost cost = {};
+    cost.name = layer->layerName();
+    cost.type = layer->layerType();
+    cost.live = HasLiveLayers(layer);
+    report->layers.push_back(cost);
+    layers.push_back(layer);
+  }
+  int64_t frameTime = 0;
+  int64_t frameCount = 0;
+  for (int64_t sample = 0; sample < numSamples; sample++) {
+    auto frame = numSamples > 1 ? sample * (report->numFrames - 1) / (numSamples - 1) : 0;
+    player->setProgress(BakeFrameToProgress(frame, report->numFrames));
+    // Decodes the assets of the frame first, they would otherwise count toward the first layer.
+    player->flush();
+    for (size_t i = 0; i < layers.size(); i++) {
+      auto& layer = layers[i];
+      if (!layer->visible()) {
+        continue;
+      }
+      layer->setVisible(false);
+      auto hiddenTime = TimeFlush(player);
+      layer->setVisible(true);
+      auto fullTime = TimeFlush(player);
+      report->layers[i].cost += std::max<int64_t>(0, fullTime - hiddenTime);
+      frameTime += fullTime;
+      frameCount++;
+    }
+  }
+  for (auto& cost : report->layers) {
+    cost.cost /= std::max<int64_t>(1, numSamples);
+  }
+  report->frameCost = frameCount > 0 ? frameTime / frameCount : 0;
+}
+
+static bool CompressFrame(const std::vector<uint8_t>& pixels, std::vector<uint8_t>* output,
+                          uint32_t* compression) {
+#ifdef PAG4J_USE_ZLIB
+  auto size = compressBound(static_cast<uLong>(pixels.size()));
+  output->resize(size);
+  if (compress2(output->data(), &size, pixels.data(), static_cast<uLong>(pixels.size()),
+                BakeCompressionLevel) != Z_OK) {
+    return false;
+  }
+  output->resize(size);
+  *compression = CompressionDeflate;
+#else
+  *output = pixels;
+  *compression = CompressionNone;
+#endif
+  return true;
+}
+
+static bool WriteFrames(PAGPlayer* player, PAGSurface* surface, FILE* output,
+                        BakeReport* report) {
+  PAG4J_TRACE_EVENT("pag", "BakeFile::write");
+  BakeHeader header = {};
+  header.width = report->width;
+  header.height = report->height;
+  header.frameRate = player->getComposition()->frameRate();
+  header.numFrames = report->numFrames;
+  header.numLayers = static_cast<int32_t>(report->layers.size());
+  header.bakedLayers = report->bakedLayers;
+  std::vector<BakeFrameEntry> entries(static_cast<size_t>(report->numFrames));
+  auto tableSize = entries.size() * sizeof(BakeFrameEntry);
+  // The table is written again once the offsets are known.
+  if (fwrite(&header, sizeof(header), 1, output) != 1 ||
+      fwrite(entries.data(), tableSize, 1, output) != 1) {
+    return false;
+  }
+  auto offset = static_cast<uint64_t>(sizeof(header) + tableSize);
+  auto rowBytes = static_cast<size_t>(report->width) * 4;
+  std::vector<uint8_t> pixels(rowBytes * report->height);
+  std::vector<uint8_t> data = {};
+  for (int64_t frame = 0; frame < report->numFrames; frame++) {
+    player->setProgress(BakeFrameToProgress(frame, report->numFrames));
+    auto changed = player->flush();
+    if (frame > 0 && !changed) {
+      entries[frame] = entries[frame - 1];
+      continue;
+    }
+    if (!surface->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied, pixels.data(),
+                             rowBytes) ||
+        !CompressFrame(pixels, &data, &header.compression) ||
+        fwrite(data.data(), data.size(), 1, output) != 1) {
+      return false;
+    }
+    entries[frame].offset = offset;
+    entries[frame].size = static_cast<uint32_t>(data.size());
+    offset += data.size();
+    report->uniqueFrames++;
+  }
+  report->bakedBytes = static_cast<int64_t>(offset);
+  return SeekFile(output, 0, SEEK_SET) && fwrite(&header, sizeof(header), 1, output) == 1 &&
+         fwrite(entries.data(), tableSize, 1, output) == 1;
+}
+
+static void MeasureReadCost(const std::string& path, BakeReport* report) {
+  auto frames = JBakedFrames::Open(path);
+  if (frames == nullptr) {
+    return;
+  }
+  auto numSamples = std::min(report->numFrames, MaxCostSamples);
+  std::vector<uint8_t> pixels(static_cast<size_t>(report->width) * report->height * 4);
+  auto startTime = GetTimeMicros();
+  for (int64_t sample = 0; sample < numSamples; sample++) {
+    auto frame = numSamples > 1 ? sample * (report->numFrames - 1) / (numSamples - 1) : 0;
+    frames->readFrame(frame, pixels.data(), static_cast<size_t>(report->width) * 4);
+  }
+  report->readCost = (GetTimeMicros() - startTime) / std::max<int64_t>(1, numSamples);
+}
+
+bool BakeFile(std::shared_ptr<PAGFile> file, float scale, const std::string& path,
+              BakeReport* report) {
+  PAG4J_TRACE_EVENT("pag", "BakeFile");
+  if (file == nullptr || report == nullptr || !(scale > 0)) {
+    return false;
+  }
+  *report = {};
+  // A copy keeps the file in the player it may already be shown by.
+  auto source = file->copyOriginal();
+  if (source == nullptr) {
+    return false;
+  }
+  report->width = std::max(1, static_cast<int>(std::round(source->width() * scale)));
+  report->height = std::max(1, static_cast<int>(std::round(source->height() * scale)));
+  report->numFrames = BakeFrameCount(source);
+  auto surface = PAGSurface::MakeOffscreen(report->width, report->height);
+  if (surface == nullptr) {
+    return false;
+  }
+  auto player = std::make_shared<PAGPlayer>();
+  player->setSurface(surface);
+  player->setComposition(source);
+  player->setMaxFrameRate(source->frameRate());
+  MeasureLayerCosts(player.get(), source, report);
+  // The layers above the lowest live layer are drawn over live content, so they stay live as well.
+  auto liveLayer = std::find_if(report->layers.begin(), report->layers.end(),
+                                [](const BakeLayerCost& cost) { return cost.live; });
+  report->bakedLayers = static_cast<int>(liveLayer - report->layers.begin());
+  if (report->bakedLayers == 0) {
+    return true;
+  }
+  for (int i = 0; i < report->bakedLayers; i++) {
+    report->layers[i].baked = true;
+  }
+  // The sidecar only holds the baked layers, the others are rendered live over it.
+  for (int i = report->bakedLayers; i < source->numChildren(); i++) {
+    auto layer = source->getLayerAt(i);
+    if (layer != nullptr) {
+      layer->setVisible(false);
+    }
+  }
+  auto output = fopen(path.c_str(), "wb");
+  if (output == nullptr) {
+    return false;
+  }
+  auto success = WriteFrames(player.get(), surface.get(), output, report);
+  success = fclose(output) == 0 && success;
+  if (!success) {
+    remove(path.c_str());
+    return false;
+  }
+  report->baked = true;
+  MeasureReadCost(path, report);
+  return true;
+}
+
+std::shared_ptr<JBakedFrames> JBakedFrames::Open(const std::string& path) {
+  auto file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return nullptr;
+  }
+  auto frames = std::shared_ptr<JBakedFrames>(new JBakedFrames());
+  frames->file = file;
+  if (!SeekFile(file, 0, SEEK_END)) {
+    return nullptr;
+  }
+  auto fileSize = TellFile(file);
+  BakeHeader header = {};
+  if (fileSize < static_cast<int64_t>(sizeof(header)) || !SeekFile(file, 0, SEEK_SET) ||
+      fread(&header, sizeof(header), 1, file) != 1 || header.magic != BakeMagic ||
+      header.version != BakeVersion || header.width <= 0 || header.height <= 0 ||
+      header.numFrames <= 0 || header.bakedLayers < 0 || header.bakedLayers > header.numLayers) {
+    return nullptr;
+  }
+  // The frame table has to fit the file, a damaged header must not allocate an arbitrary table or
+  // frame buffer.
+  auto maxFrames = (static_cast<uint64_t>(fileSize) - sizeof(header)) / sizeof(BakeFrameEntry);
+  auto frameSize = static_cast<uint64_t>(header.width) * static_cast<uint64_t>(header.height) * 4;
+  if (static_cast<uint64_t>(header.numFrames) > maxFrames || frameSize > MaxFrameSize ||
+      (header.compression != CompressionNone && header.compression != CompressionDeflate)) {
+    return nullptr;
+  }
+#ifndef PAG4J_USE_ZLIB
+  if (header.compression == CompressionDeflate) {
+    return nullptr;
+  }
+#endif
+  frames->_width = header.width;
+  frames->_height = header.height;
+  frames->_frameRate = header.frameRate;
+  frames->_numLayers = header.numLayers;
+  frames->_bakedLayers = header.bakedLayers;
+  frames->compression = header.compression;
+  frames->entries.resize(static_cast<size_t>(header.numFrames));
+  if (fread(frames->entries.data(), sizeof(BakeFrameEntry), frames->entries.size(), file) !=
+      frames->entries.size()) {
+    return nullptr;
+  }
+  for (auto& entry : frames->entries) {
+    if (entry.offset > static_cast<uint64_t>(fileSize) ||
+        entry.size > static_cast<uint64_t>(fileSize) - entry.offset) {
+      return nullptr;
+    }
+    if (header.compression == CompressionNone ? entry.size != frameSize
+                                              : entry.size * MaxDeflateRatio + 64 < frameSize) {
+      return nullptr;
+    }
+  }
+  return frames;
+}
+
+JBakedFrames::~JBakedFrames() {
+  if (file != nullptr) {
+    fclose(file);
+  }
+}
+
+/**
+ * Draws the premultiplied source beneath the premultiplied target, which is source-over with the
+ * two swapped: target + source * (1 - target alpha).
+ */
+static void BlendBeneath(const uint8_t* source, uint8_t* target, int width) {
+  for (int x = 0; x < width; x++, source += 4, target += 4) {
+    auto inverseAlpha = 255 - target[3];
+    if (inverseAlpha == 0) {
+      continue;
+    }
+    for (int channel = 0; channel < 4; channel++) {
+      // Divides by 255 with rounding.
+      auto value = source[channel] * inverseAlpha + 128;
+      target[channel] = static_cast<uint8_t>(target[channel] + ((value + (value >> 8)) >> 8));
+    }
+  }
+}
+
+bool JBakedFrames::readFrame(int64_t frame, void* pixels, size_t rowBytes) {
+  return drawFrame(frame, static_cast<uint8_t*>(pixels), rowBytes, false);
+}
+
+bool JBakedFrames::compositeFrame(int64_t frame, void* pixels, size_t rowBytes) {
+  return drawFrame(frame, static_cast<uint8_t*>(pixels), rowBytes, true);
+}
+
+bool JBakedFrames::drawFrame(int64_t frame, uint8_t* pixels, size_t rowBytes, bool beneath) {
+  if (frame < 0 || frame >= numFrames() || pixels == nullptr) {
+    return false;
+  }
+  auto rowSize = static_cast<size_t>(_width) * 4;
+  if (rowBytes < rowSize) {
+    return false;
+  }
+  std::lock_guard<std::mutex> autoLock(locker);
+  auto& entry = entries[static_cast<size_t>(frame)];
+  if (entry.offset != decodedOffset && !decodeFrame(entry)) {
+    return false;
+  }
+  for (int y = 0; y < _height; y++) {
+    if (beneath) {
+      BlendBeneath(decoded.data() + rowSize * y, pixels + rowBytes * y, _width);
+    } else {
+      memcpy(pixels + rowBytes * y, decoded.data() + rowSize * y, rowSize);
+    }
+  }
+  return true;
+}
+
+bool JBakedFrames::decodeFrame(const BakeFrameEntry& entry) {
+  PAG4J_TRACE_EVENT("pag", "JBakedFrames::decodeFrame");
+  decodedOffset = UINT64_MAX;
+  auto frameSize = static_cast<size_t>(_width) * _height * 4;
+  decoded.resize(frameSize);
+  auto target = compression == CompressionNone ? &decoded : &buffer;
+  if (compression == CompressionNone && entry.size != frameSize) {
+    return false;
+  }
+  target->resize(entry.size);
+  if (!SeekFile(file, entry.offset, SEEK_SET) ||
+      fread(target->data(), 1, entry.size, file) != entry.size) {
+    return false;
+  }
+#ifdef PAG4J_USE_ZLIB
+  if (compression == CompressionDeflate) {
+    auto size = static_cast<uLongf>(frameSize);
+    if (uncompress(decoded.data(), &size, buffer.data(), static_cast<uLong>(buffer.size())) !=
+            Z_OK ||
+        size != frameSize) {
+      return false;
+    }
+  }
+#endif
+  decodedOffset = entry.offset;
+  return true;
+}
+}  // namespace pag
@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * The measured cost of a child layer of the root composition.
+ */
+struct BakeLayerCost {
+  std::string name = {};
+  LayerType type = LayerType::Unknown;
+  // True if the layer is or contains an editable text or image layer, which must stay live.
+  bool live = false;
+  // True if the layer is drawn from the sidecar instead of being rendered.
+  bool baked = false;
+  // The average time in microseconds the layer adds to rendering a frame.
+  int64_t cost = 0;
+};
+
+struct BakeReport {
+  // False if the bottom child layer is live, then only the costs are measured and no frames are
+  // written.
+  bool baked = false;
+  // The number of child layers baked, counted from the bottom. Equals the number of layers if the
+  // whole file is baked.
+  int bakedLayers = 0;
+  int width = 0;
+  int height = 0;
+  int64_t numFrames = 0;
+  int64_t uniqueFrames = 0;
+  int64_t bakedBytes = 0;
+  // The average time in microseconds to render a frame of the file and to read a baked frame.
+  int64_t frameCost = 0;
+  int64_t readCost = 0;
+  std::vector<BakeLayerCost> layers = {};
+};
+
+/**
+ * Bakes the original content of the file into a sidecar of pre-rendered frames at the scale, and
+ * measures what each child layer of the root composition costs per frame. The frames are rendered
+ * with libpag's change detection, so a frame that renders the same content as the one before it
+ * is stored once and referenced again. They are deflated with zlib if it is available at build
+ * time. If the file has live layers, only the child layers beneath the lowest live one are baked,
+ * the layers from there up are rendered live and drawn over the baked frames, see
+ * JBakedFrames::compositeFrame(). If the bottom child layer is live, the sidecar is not written
+ * and only the report is filled in. Returns false if the file could not be rendered or the sidecar
+ * could not be written.
+ */
+bool BakeFile(std::shared_ptr<PAGFile> file, float scale, const std::string& path,
+              BakeReport* report);
+
+/**
+ * Locates a frame in the sidecar. Duplicate frames share the entry of the frame they repeat.
+ */
+struct BakeFrameEntry {
+  uint64_t offset = 0;
+  uint32_t size = 0;
+  uint32_t reserved = 0;
+};
+
+/**
+ * Reads the frames of a sidecar written by BakeFile(). The frames are tightly packed RGBA pixels
+ * with premultiplied alpha. Reads are serialized, and the last frame read is kept decoded, so the
+ * runs of duplicate frames cost a copy each.
+ */
+class JBakedFrames {
+ public:
+  /**
+   * Returns nullptr if the file is not a sidecar of a supported version, or if its frames are
+   * compressed and zlib is not available.
+   */
+  static std::shared_ptr<JBakedFrames> Open(const std::string& path);
+
+  ~JBakedFrames();
+
+  int width() const {
+    return _width;
+  }
+
+  int height() const {
+    return _height;
+  }
+
+  float frameRate() const {
+    return _frameRate;
+  }
+
+  int64_t numFrames() const {
+    return static_cast<int64_t>(entries.size());
+  }
+
+  /**
+   * Returns the number of child layers of the root composition when the file was baked.
+   */
+  int numLayers() const {
+    return _numLayers;
+  }
+
+  /**
+   * Returns the number of child layers in the frames, counted from the bottom. The other layers
+   * have to be rendered live unless it equals numLayers().
+   */
+  int bakedLayers() const {
+    return _bakedLayers;
+  }
+
+  /**
+   * Copies the frame to the pixels, rowBytes apart. Returns false if the frame is out of range or
+   * could not be read.
+   */
+  bool readFrame(int64_t frame, void* pixels, size_t rowBytes);
+
+  /**
+   * Draws the frame beneath the premultiplied pixels, rowBytes apart, which hold the live layers
+   * rendered on a transparent surface. Returns false if the frame is out of range or could not be
+   * read.
+   */
+  bool compositeFrame(int64_t frame, void* pixels, size_t rowBytes);
+
+ private:
+  FILE* file = nullptr;
+  int _width = 0;
+  int _height = 0;
+  float _frameRate = 0;
+  int _numLayers = 0;
+  int _bakedLayers = 0;
+  uint32_t compression = 0;
+  std::vector<BakeFrameEntry> entries = {};
+  std::mutex locker = {};
+  uint64_t decodedOffset = UINT64_MAX;
+  std::vector<uint8_t> decoded = {};
+  std::vector<uint8_t> buffer = {};
+
+  JBakedFrames() = default;
+
+  bool drawFrame(int64_t frame, uint8_t* pixels, size_t rowBytes, bool beneath);
+  bool decodeFrame(const BakeFrameEntry& entry);
+};
+}  // namespace pag
@@ -0,0 +1,109 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JDirtyRegion.h"
+#include <algorithm>
+#include <cstring>
+
+namespace pag {
+static constexpr int TileSize = 32;
+// Falls back to a single bounding rectangle if the changes are too scattered, uploading a few
+// extra pixels is cheaper than issuing hundreds of tiny copies.
+static constexpr size_t MaxDirtyRects = 32;
+
+static bool IsTileDirty(const uint8_t* current, const uint8_t* previous, size_t rowBytes,
+                        int x, int y, int width, int height) {
+  auto offset = static_cast<size_t>(y) * rowBytes + static_cast<size_t>(x) * 4;
+  auto length = static_cast<size_t>(width) * 4;
+  for (int row = 0; row < height; row++) {
+    if (memcmp(current + offset, previous + offset, length) != 0) {
+      return true;
+    }
+    offset += rowBytes;
+  }
+  return false;
+}
+
+std::vector<DirtyRect> JDirtyRegion::update(std::vector<uint8_t>* frame, int width, int height) {
+  std::vector<DirtyRect> rects = {};
+  if (frame == nullptr || width <= 0 || height <= 0) {
+    return rects;
+  }
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  if (width != lastWidth || height != lastHeight || previous.size() != frame->size()) {
+    rects.push_back({0, 0, width, height});
+    lastWidth = width;
+    lastHeight = height;
+    previous.swap(*frame);
+    return rects;
+  }
+  auto current = frame->data();
+  // Dirty rectangles of the previous tile row, extended downwards while the next row has a
+  // dirty run with the same horizontal span.
+  std::vector<DirtyRect> openRects = {};
+  for (int tileY = 0; tileY < height; tileY += TileSize) {
+    auto tileHeight = std::min(TileSize, height - tileY);
+    std::vector<DirtyRect> rowRects = {};
+    for (int tileX = 0; tileX < width; tileX += TileSize) {
+      auto tileWidth = std::min(TileSize, width - tileX);
+      if (!IsTileDirty(current, previous.data(), rowBytes, tileX, tileY, tileWidth, tileHeight)) {
+        continue;
+      }
+      if (!rowRects.empty() && rowRects.back().x + rowRects.back().width == tileX) {
+        rowRects.back().width += tileWidth;
+      } else {
+        rowRects.push_back({tileX, tileY, tileWidth, tileHeight});
+      }
+    }
+    std::vector<DirtyRect> nextOpenRects = {};
+    for (auto& rect : rowRects) {
+      auto match = std::find_if(openRects.begin(), openRects.end(), [&](const DirtyRect& open) {
+        return open.x == rect.x && open.width == rect.width;
+      });
+      if (match != openRects.end()) {
+        match->height += rect.height;
+        nextOpenRects.push_back(*match);
+        openRects.erase(match);
+      } else {
+        nextOpenRects.push_back(rect);
+      }
+    }
+    rects.insert(rects.end(), openRects.begin(), openRects.end());
+    openRects.swap(nextOpenRects);
+  }
+  rects.insert(rects.end(), openRects.begin(), openRects.end());
+  if (rects.size() > MaxDirtyRects) {
+    auto left = width, top = height, right = 0, bottom = 0;
+    for (auto& rect : rects) {
+      left = std::min(left, rect.x);
+      top = std::min(top, rect.y);
+      right = std::max(right, rect.x + rect.width);
+      bottom = std::max(bottom, rect.y + rect.height);
+    }
+    rects = {{left, top, right - left, bottom - top}};
+  }
+  previous.swap(*frame);
+  return rects;
+}
+
+void JDirtyRegion::reset() {
+  previous = {};
+  lastWidth = 0;
+  lastHeight = 0;
+}
+}  // namespace pag
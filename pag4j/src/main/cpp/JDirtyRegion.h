@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pag {
+struct DirtyRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+/**
+ * Tracks the pixels of the last frame read back from a surface and reports which regions of the
+ * next frame differ from it. The comparison runs on a fixed tile grid, adjacent dirty tiles are
+ * merged into larger rectangles.
+ */
+class JDirtyRegion {
+ public:
+  /**
+   * Returns the regions of the tightly packed RGBA frame that differ from the previous frame, and
+   * keeps the frame as the reference for the next call. The whole frame is reported as dirty if
+   * there is no previous frame or the size has changed.
+   */
+  std::vector<DirtyRect> update(std::vector<uint8_t>* frame, int width, int height);
+
+  /**
+   * Returns the pixels of the last frame passed to update().
+   */
+  const std::vector<uint8_t>& lastFrame() const {
+    return previous;
+  }
+
+  void reset();
+
+ private:
+  std::vector<uint8_t> previous = {};
+  int lastWidth = 0;
+  int lastHeight = 0;
+};
+}  // namespace pag
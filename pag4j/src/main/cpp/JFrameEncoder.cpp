@@ -0,0 +1,234 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JFrameEncoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef PAG4J_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace pag {
+static void WriteUInt32(std::vector<uint8_t>* output, uint32_t value) {
+  output->push_back(static_cast<uint8_t>(value >> 24));
+  output->push_back(static_cast<uint8_t>(value >> 16));
+  output->push_back(static_cast<uint8_t>(value >> 8));
+  output->push_back(static_cast<uint8_t>(value));
+}
+
+#ifdef PAG4J_USE_ZLIB
+
+static uint32_t ComputeCRC(const uint8_t* data, size_t size) {
+  return static_cast<uint32_t>(crc32(0, data, static_cast<uInt>(size)));
+}
+
+// Favors speed over size, the default level is several times slower for about 10% smaller files.
+static constexpr int PNGCompressionLevel = 3;
+
+static bool Deflate(const std::vector<uint8_t>& data, std::vector<uint8_t>* output) {
+  auto bound = compressBound(static_cast<uLong>(data.size()));
+  auto offset = output->size();
+  output->resize(offset + bound);
+  auto size = bound;
+  if (compress2(output->data() + offset, &size, data.data(), static_cast<uLong>(data.size()),
+                PNGCompressionLevel) != Z_OK) {
+    output->resize(offset);
+    return false;
+  }
+  output->resize(offset + size);
+  return true;
+}
+
+#else
+
+static uint32_t ComputeCRC(const uint8_t* data, size_t size) {
+  static const auto table = [] {
+    std::vector<uint32_t> values(256);
+    for (uint32_t i = 0; i < 256; i++) {
+      auto value = i;
+      for (int k = 0; k < 8; k++) {
+        value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+      }
+      values[i] = value;
+    }
+    return values;
+  }();
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+static uint32_t ComputeAdler32(const std::vector<uint8_t>& data) {
+  uint32_t a = 1;
+  uint32_t b = 0;
+  size_t index = 0;
+  while (index < data.size()) {
+    // 5552 is the largest block that can not overflow b before the modulo.
+    auto end = std::min(data.size(), index + 5552);
+    for (; index < end; index++) {
+      a += data[index];
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+
+static bool Deflate(const std::vector<uint8_t>& data, std::vector<uint8_t>* output) {
+  output->push_back(0x78);
+  output->push_back(0x01);
+  size_t index = 0;
+  do {
+    auto blockSize = std::min<size_t>(data.size() - index, 65535);
+    auto last = index + blockSize == data.size();
+    output->push_back(last ? 1 : 0);
+    output->push_back(static_cast<uint8_t>(blockSize));
+    output->push_back(static_cast<uint8_t>(blockSize >> 8));
+    output->push_back(static_cast<uint8_t>(~blockSize));
+    output->push_back(static_cast<uint8_t>(~blockSize >> 8));
+    output->insert(output->end(), data.begin() + index, data.begin() + index + blockSize);
+    index += blockSize;
+  } while (index < data.size());
+  WriteUInt32(output, ComputeAdler32(data));
+  return true;
+}
+
+#endif
+
+static void WriteChunk(std::vector<uint8_t>* output, const char* type, const uint8_t* data,
+                       size_t size) {
+  WriteUInt32(output, static_cast<uint32_t>(size));
+  auto offset = output->size();
+  output->insert(output->end(), type, type + 4);
+  if (size > 0) {
+    output->insert(output->end(), data, data + size);
+  }
+  WriteUInt32(output, ComputeCRC(output->data() + offset, size + 4));
+}
+
+bool EncodePNG(const uint8_t* pixels, int width, int height, std::vector<uint8_t>* output) {
+  static const uint8_t Signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  output->insert(output->end(), Signature, Signature + sizeof(Signature));
+
+  std::vector<uint8_t> header = {};
+  WriteUInt32(&header, static_cast<uint32_t>(width));
+  WriteUInt32(&header, static_cast<uint32_t>(height));
+  // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlace.
+  header.insert(header.end(), {8, 6, 0, 0, 0});
+  WriteChunk(output, "IHDR", header.data(), header.size());
+
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  std::vector<uint8_t> scanlines(static_cast<size_t>(height) * (rowBytes + 1));
+  auto line = scanlines.data();
+  for (int y = 0; y < height; y++) {
+    auto row = pixels + rowBytes * y;
+#ifdef PAG4J_USE_ZLIB
+    // The Sub filter turns the flat areas and gradients of vector content into runs of zeros.
+    *line++ = 1;
+    memcpy(line, row, 4);
+    for (size_t i = 4; i < rowBytes; i++) {
+      line[i] = static_cast<uint8_t>(row[i] - row[i - 4]);
+    }
+#else
+    // Stored blocks can not benefit from filtering.
+    *line++ = 0;
+    memcpy(line, row, rowBytes);
+#endif
+    line += rowBytes;
+  }
+  std::vector<uint8_t> imageData = {};
+  if (!Deflate(scanlines, &imageData)) {
+    return false;
+  }
+  WriteChunk(output, "IDAT", imageData.data(), imageData.size());
+  WriteChunk(output, "IEND", nullptr, 0);
+  return true;
+}
+
+std::string MakeY4MHeader(int width, int height, float frameRate) {
+  std::string rate = {};
+  if (std::fabs(frameRate - std::round(frameRate)) < 0.001f) {
+    rate = std::to_string(static_cast<int>(std::round(frameRate))) + ":1";
+  } else {
+    rate = std::to_string(static_cast<int>(std::round(frameRate * 1000))) + ":1000";
+  }
+  return "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " F" + rate +
+         " Ip A1:1 C420jpeg\n";
+}
+
+static inline uint8_t ToY(int r, int g, int b) {
+  return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+static inline uint8_t ToU(int r, int g, int b) {
+  return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+static inline uint8_t ToV(int r, int g, int b) {
+  return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+void EncodeY4MFrame(const uint8_t* pixels, int width, int height, std::vector<uint8_t>* output) {
+  static const char FrameTag[] = "FRAME\n";
+  output->insert(output->end(), FrameTag, FrameTag + sizeof(FrameTag) - 1);
+  auto chromaWidth = (width + 1) / 2;
+  auto chromaHeight = (height + 1) / 2;
+  auto lumaSize = static_cast<size_t>(width) * height;
+  auto chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+  auto offset = output->size();
+  output->resize(offset + lumaSize + chromaSize * 2);
+  auto yPlane = output->data() + offset;
+  auto uPlane = yPlane + lumaSize;
+  auto vPlane = uPlane + chromaSize;
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  for (int y = 0; y < height; y++) {
+    auto row = pixels + rowBytes * y;
+    auto yRow = yPlane + static_cast<size_t>(width) * y;
+    for (int x = 0; x < width; x++) {
+      auto pixel = row + x * 4;
+      yRow[x] = ToY(pixel[0], pixel[1], pixel[2]);
+    }
+  }
+  for (int cy = 0; cy < chromaHeight; cy++) {
+    auto top = cy * 2;
+    auto bottom = std::min(top + 1, height - 1);
+    for (int cx = 0; cx < chromaWidth; cx++) {
+      auto left = cx * 2;
+      auto right = std::min(left + 1, width - 1);
+      int r = 0;
+      int g = 0;
+      int b = 0;
+      for (auto y : {top, bottom}) {
+        for (auto x : {left, right}) {
+          auto pixel = pixels + rowBytes * y + x * 4;
+          r += pixel[0];
+          g += pixel[1];
+          b += pixel[2];
+        }
+      }
+      auto index = static_cast<size_t>(chromaWidth) * cy + cx;
+      uPlane[index] = ToU((r + 2) / 4, (g + 2) / 4, (b + 2) / 4);
+      vPlane[index] = ToV((r + 2) / 4, (g + 2) / 4, (b + 2) / 4);
+    }
+  }
+}
+}  // namespace pag
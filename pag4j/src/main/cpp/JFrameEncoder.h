@@ -0,0 +1,45 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pag {
+/**
+ * Encodes a tightly packed RGBA frame with unpremultiplied alpha as an 8-bit PNG image and appends
+ * it to the output. The image data is deflated with zlib if it is available at build time,
+ * otherwise it is written as stored deflate blocks. Returns false if the data could not be
+ * compressed.
+ */
+bool EncodePNG(const uint8_t* pixels, int width, int height, std::vector<uint8_t>* output);
+
+/**
+ * Returns the YUV4MPEG2 stream header for frames of the specified size and frame rate.
+ */
+std::string MakeY4MHeader(int width, int height, float frameRate);
+
+/**
+ * Converts a tightly packed RGBA frame to BT.601 limited range YUV 4:2:0 and appends it to the
+ * output as a YUV4MPEG2 frame. The alpha channel is dropped, so the frame should be read with
+ * premultiplied alpha to be composited over black.
+ */
+void EncodeY4MFrame(const uint8_t* pixels, int width, int height, std::vector<uint8_t>* output);
+}  // namespace pag
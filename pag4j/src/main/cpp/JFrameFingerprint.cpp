@@ -0,0 +1,274 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JFrameFingerprint.h"
+#include <algorithm>
+#include <cstring>
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+namespace pag {
+static constexpr uint64_t Prime1 = 11400714785074694791ULL;
+static constexpr uint64_t Prime2 = 14029467366897019727ULL;
+static constexpr uint64_t Prime3 = 1609587929392839161ULL;
+static constexpr uint64_t Prime4 = 9650029242287828579ULL;
+static constexpr uint64_t Prime5 = 2870177450012600261ULL;
+
+static inline uint64_t RotateLeft(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t Read64(const uint8_t* data) {
+  uint64_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static inline uint32_t Read32(const uint8_t* data) {
+  uint32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static inline uint64_t Round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * Prime2;
+  accumulator = RotateLeft(accumulator, 31);
+  return accumulator * Prime1;
+}
+
+static inline uint64_t MergeRound(uint64_t accumulator, uint64_t value) {
+  accumulator ^= Round(0, value);
+  return accumulator * Prime1 + Prime4;
+}
+
+XXH64Hasher::XXH64Hasher(uint64_t seed) : seed(seed) {
+  lanes[0] = seed + Prime1 + Prime2;
+  lanes[1] = seed + Prime2;
+  lanes[2] = seed;
+  lanes[3] = seed - Prime1;
+}
+
+void XXH64Hasher::update(const void* data, size_t length) {
+  auto bytes = static_cast<const uint8_t*>(data);
+  totalLength += length;
+  if (bufferSize + length < sizeof(buffer)) {
+    memcpy(buffer + bufferSize, bytes, length);
+    bufferSize += length;
+    return;
+  }
+  if (bufferSize > 0) {
+    auto fill = sizeof(buffer) - bufferSize;
+    memcpy(buffer + bufferSize, bytes, fill);
+    for (int i = 0; i < 4; i++) {
+      lanes[i] = Round(lanes[i], Read64(buffer + i * 8));
+    }
+    bytes += fill;
+    length -= fill;
+    bufferSize = 0;
+  }
+  // The four lanes are independent, which lets the CPU run their multiplications in parallel.
+  auto lane0 = lanes[0];
+  auto lane1 = lanes[1];
+  auto lane2 = lanes[2];
+  auto lane3 = lanes[3];
+  while (length >= 32) {
+    lane0 = Round(lane0, Read64(bytes));
+    lane1 = Round(lane1, Read64(bytes + 8));
+    lane2 = Round(lane2, Read64(bytes + 16));
+    lane3 = Round(lane3, Read64(bytes + 24));
+    bytes += 32;
+    length -= 32;
+  }
+  lanes[0] = lane0;
+  lanes[1] = lane1;
+  lanes[2] = lane2;
+  lanes[3] = lane3;
+  memcpy(buffer, bytes, length);
+  bufferSize = length;
+}
+
+uint64_t XXH64Hasher::digest() const {
+  uint64_t hash = 0;
+  if (totalLength >= 32) {
+    hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) +
+           RotateLeft(lanes[3], 18);
+    for (auto lane : lanes) {
+      hash = MergeRound(hash, lane);
+    }
+  } else {
+    hash = seed + Prime5;
+  }
+  hash += totalLength;
+  auto bytes = buffer;
+  auto remaining = bufferSize;
+  while (remaining >= 8) {
+    hash ^= Round(0, Read64(bytes));
+    hash = RotateLeft(hash, 27) * Prime1 + Prime4;
+    bytes += 8;
+    remaining -= 8;
+  }
+  if (remaining >= 4) {
+    hash ^= static_cast<uint64_t>(Read32(bytes)) * Prime1;
+    hash = RotateLeft(hash, 23) * Prime2 + Prime3;
+    bytes += 4;
+    remaining -= 4;
+  }
+  while (remaining > 0) {
+    hash ^= (*bytes) * Prime5;
+    hash = RotateLeft(hash, 11) * Prime1;
+    bytes++;
+    remaining--;
+  }
+  hash ^= hash >> 33;
+  hash *= Prime2;
+  hash ^= hash >> 29;
+  hash *= Prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+uint64_t HashPixels(const uint8_t* pixels, int width, int height, size_t rowBytes) {
+  PAG4J_TRACE_EVENT("pag", "HashPixels");
+  XXH64Hasher hasher;
+  auto lineBytes = static_cast<size_t>(width) * 4;
+  if (rowBytes == lineBytes) {
+    hasher.update(pixels, lineBytes * height);
+  } else {
+    for (int row = 0; row < height; row++) {
+      hasher.update(pixels + row * rowBytes, lineBytes);
+    }
+  }
+  return hasher.digest();
+}
+
+// Every cell is sampled on a grid of at most this many points per side, which keeps the signature
+// cheap for 4K frames while still averaging over the whole cell.
+static constexpr int MaxSamplesPerCell = 16;
+
+uint64_t PerceptualHash(const uint8_t* pixels, int width, int height, size_t rowBytes) {
+  PAG4J_TRACE_EVENT("pag", "PerceptualHash");
+  if (width <= 0 || height <= 0) {
+    return 0;
+  }
+  uint32_t cells[64] = {};
+  uint64_t total = 0;
+  for (int cellY = 0; cellY < 8; cellY++) {
+    auto top = height * cellY / 8;
+    auto bottom = std::max(top + 1, height * (cellY + 1) / 8);
+    auto stepY = std::max(1, (bottom - top) / MaxSamplesPerCell);
+    for (int cellX = 0; cellX < 8; cellX++) {
+      auto left = width * cellX / 8;
+      auto right = std::max(left + 1, width * (cellX + 1) / 8);
+      auto stepX = std::max(1, (right - left) / MaxSamplesPerCell);
+      uint32_t sum = 0;
+      uint32_t count = 0;
+      for (auto y = top; y < bottom; y += stepY) {
+        auto row = pixels + y * rowBytes;
+        for (auto x = left; x < right; x += stepX) {
+          auto pixel = row + x * 4;
+          // BT.601 luma of the premultiplied color, which is the color composited over black.
+          sum += (77u * pixel[0] + 150u * pixel[1] + 29u * pixel[2]) >> 8;
+          count++;
+        }
+      }
+      auto luma = sum / count;
+      cells[cellY * 8 + cellX] = luma;
+      total += luma;
+    }
+  }
+  auto mean = total / 64;
+  uint64_t signature = 0;
+  for (int i = 0; i < 64; i++) {
+    if (cells[i] > mean) {
+      signature |= uint64_t(1) << i;
+    }
+  }
+  return signature;
+}
+
+void WriteFingerprint(JNIEnv* env, jlongArray fingerprint, const uint8_t* pixels, int width,
+                      int height, size_t rowBytes) {
+  if (fingerprint == nullptr) {
+    return;
+  }
+  auto length = env->GetArrayLength(fingerprint);
+  if (length <= 0) {
+    return;
+  }
+  jlong values[2] = {static_cast<jlong>(HashPixels(pixels, width, height, rowBytes)), 0};
+  if (length >= 2) {
+    values[1] = static_cast<jlong>(PerceptualHash(pixels, width, height, rowBytes));
+  }
+  env->SetLongArrayRegion(fingerprint, 0, std::min<jsize>(length, 2), values);
+}
+}  // namespace pag
+
+using namespace pag;
+
+static const uint8_t* GetPixels(JNIEnv* env, jobject pixels, jint width, jint height,
+                                jint stride) {
+  if (pixels == nullptr || width <= 0 || height <= 0 || stride < width * 4) {
+    return nullptr;
+  }
+  auto address = env->GetDirectBufferAddress(pixels);
+  auto capacity = env->GetDirectBufferCapacity(pixels);
+  if (address == nullptr ||
+      capacity < static_cast<jlong>(stride) * (height - 1) + static_cast<jlong>(width) * 4) {
+    return nullptr;
+  }
+  return static_cast<const uint8_t*>(address);
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGFrameFingerprint_nativeHash(JNIEnv* env, jclass,
+                                                                      jobject pixels, jint width,
+                                                                      jint height, jint stride) {
+  auto data = GetPixels(env, pixels, width, height, stride);
+  if (data == nullptr) {
+    return 0;
+  }
+  return static_cast<jlong>(HashPixels(data, width, height, static_cast<size_t>(stride)));
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGFrameFingerprint_nativePerceptualHash(
+    JNIEnv* env, jclass, jobject pixels, jint width, jint height, jint stride) {
+  auto data = GetPixels(env, pixels, width, height, stride);
+  if (data == nullptr) {
+    return 0;
+  }
+  return static_cast<jlong>(PerceptualHash(data, width, height, static_cast<size_t>(stride)));
+}
+}
+
+static JNINativeMethod PAGFrameFingerprint_methods[] = {
+    {"nativeHash", "(Ljava/nio/ByteBuffer;III)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFrameFingerprint_nativeHash)},
+    {"nativePerceptualHash", "(Ljava/nio/ByteBuffer;III)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFrameFingerprint_nativePerceptualHash)},
+};
+
+namespace pag {
+bool RegisterPAGFrameFingerprintNatives(JNIEnv* env) {
+  return RegisterNativeMethods(env, "org/libpag/PAGFrameFingerprint",
+                               PAGFrameFingerprint_methods,
+                               sizeof(PAGFrameFingerprint_methods) / sizeof(JNINativeMethod)) !=
+         nullptr;
+}
+}  // namespace pag
@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <jni.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace pag {
+/**
+ * Incremental XXH64, so the rows of a frame with padding between them can be hashed without
+ * gathering them first. The result equals XXH64 of the concatenated input.
+ */
+class XXH64Hasher {
+ public:
+  explicit XXH64Hasher(uint64_t seed = 0);
+
+  void update(const void* data, size_t length);
+
+  uint64_t digest() const;
+
+ private:
+  uint64_t seed = 0;
+  uint64_t lanes[4] = {};
+  uint8_t buffer[32] = {};
+  size_t bufferSize = 0;
+  uint64_t totalLength = 0;
+};
+
+/**
+ * Returns the XXH64 hash of the width * 4 bytes of every row of RGBA pixels. Identical frames have
+ * the same hash, a different hash means the frames differ in at least one pixel.
+ */
+uint64_t HashPixels(const uint8_t* pixels, int width, int height, size_t rowBytes);
+
+/**
+ * Returns a 64-bit average hash of the RGBA pixels: the luma of an 8 x 8 grid of cells, one bit per
+ * cell that is brighter than the mean of all cells. Frames that look alike have signatures with a
+ * small Hamming distance, regardless of small changes in size, compression or color.
+ */
+uint64_t PerceptualHash(const uint8_t* pixels, int width, int height, size_t rowBytes);
+
+/**
+ * Stores the hash of the pixels at index 0 of the Java array and, if it has room, the perceptual
+ * hash at index 1. Does nothing if the array is null or empty.
+ */
+void WriteFingerprint(JNIEnv* env, jlongArray fingerprint, const uint8_t* pixels, int width,
+                      int height, size_t rowBytes);
+}  // namespace pag
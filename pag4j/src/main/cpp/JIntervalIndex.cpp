@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JIntervalIndex.h"
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+namespace pag {
+JIntervalIndex::JIntervalIndex(std::vector<Interval> list) : intervals(std::move(list)) {
+  std::stable_sort(intervals.begin(), intervals.end(), [](const Interval& a, const Interval& b) {
+    return a.startTime < b.startTime;
+  });
+  maxEndTimes.resize(intervals.size());
+  build(0, intervals.size());
+}
+
+int64_t JIntervalIndex::build(size_t begin, size_t end) {
+  if (begin >= end) {
+    return std::numeric_limits<int64_t>::min();
+  }
+  auto middle = begin + (end - begin) / 2;
+  auto maxEndTime = std::max({intervals[middle].endTime, build(begin, middle),
+                              build(middle + 1, end)});
+  maxEndTimes[middle] = maxEndTime;
+  return maxEndTime;
+}
+
+void JIntervalIndex::query(int64_t startTime, int64_t endTime, std::vector<int>* values) const {
+  if (startTime < endTime) {
+    query(0, intervals.size(), startTime, endTime, values);
+  }
+}
+
+void JIntervalIndex::query(size_t begin, size_t end, int64_t startTime, int64_t endTime,
+                           std::vector<int>* values) const {
+  if (begin >= end) {
+    return;
+  }
+  auto middle = begin + (end - begin) / 2;
+  // Nothing in this subrange ends after the start of the query.
+  if (maxEndTimes[middle] <= startTime) {
+    return;
+  }
+  query(begin, middle, startTime, endTime, values);
+  auto& interval = intervals[middle];
+  // The intervals on the right start even later.
+  if (interval.startTime >= endTime) {
+    return;
+  }
+  if (interval.endTime > startTime) {
+    values->push_back(interval.value);
+  }
+  query(middle + 1, end, startTime, endTime, values);
+}
+
+static std::shared_ptr<JIntervalIndex> MakeChildLayerIndex(
+    std::shared_ptr<PAGComposition> composition) {
+  PAG4J_TRACE_EVENT("pag", "MakeChildLayerIndex");
+  std::vector<JIntervalIndex::Interval> intervals = {};
+  for (int i = 0; i < composition->numChildren(); i++) {
+    auto layer = composition->getLayerAt(i);
+    if (layer == nullptr) {
+      continue;
+    }
+    JIntervalIndex::Interval interval = {};
+    interval.value = i;
+    if (layer->excludedFromTimeline()) {
+      interval.startTime = std::numeric_limits<int64_t>::min();
+      interval.endTime = std::numeric_limits<int64_t>::max();
+    } else {
+      interval.startTime = layer->startTime();
+      interval.endTime = layer->startTime() + layer->duration();
+    }
+    intervals.push_back(interval);
+  }
+  return std::make_shared<JIntervalIndex>(std::move(intervals));
+}
+
+struct CachedLayerIndex {
+  std::weak_ptr<PAGComposition> composition;
+  uint64_t version = 0;
+  std::shared_ptr<JIntervalIndex> index = nullptr;
+};
+
+std::shared_ptr<JIntervalIndex> GetChildLayerIndex(std::shared_ptr<PAGComposition> composition) {
+  if (composition == nullptr) {
+    return nullptr;
+  }
+  static std::mutex locker;
+  static std::unordered_map<ID, CachedLayerIndex> cache;
+  auto version = ContentVersion(composition);
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    auto result = cache.find(composition->uniqueID());
+    if (result != cache.end() && result->second.version == version &&
+        result->second.composition.lock() == composition) {
+      return result->second.index;
+    }
+  }
+  auto index = MakeChildLayerIndex(composition);
+  std::lock_guard<std::mutex> autoLock(locker);
+  for (auto item = cache.begin(); item != cache.end();) {
+    if (item->second.composition.expired()) {
+      item = cache.erase(item);
+    } else {
+      ++item;
+    }
+  }
+  cache[composition->uniqueID()] = {composition, version, index};
+  return index;
+}
+}  // namespace pag
@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * A static interval tree over half-open time ranges. The intervals are sorted by their start times
+ * and the tree is implicit in the sorted array, each subrange keeps the latest end time of its
+ * intervals at its midpoint. A query visits O(log n + k) intervals, where k is the number of
+ * matches, and reports the values of the matches in the order of their start times.
+ */
+class JIntervalIndex {
+ public:
+  struct Interval {
+    int64_t startTime = 0;
+    int64_t endTime = 0;
+    int value = 0;
+  };
+
+  explicit JIntervalIndex(std::vector<Interval> intervals);
+
+  size_t size() const {
+    return intervals.size();
+  }
+
+  /**
+   * Appends the values of the intervals that contain the time.
+   */
+  void query(int64_t time, std::vector<int>* values) const {
+    query(time, time + 1, values);
+  }
+
+  /**
+   * Appends the values of the intervals that overlap the range from startTime to endTime.
+   */
+  void query(int64_t startTime, int64_t endTime, std::vector<int>* values) const;
+
+ private:
+  std::vector<Interval> intervals = {};
+  std::vector<int64_t> maxEndTimes = {};
+
+  int64_t build(size_t begin, size_t end);
+  void query(size_t begin, size_t end, int64_t startTime, int64_t endTime,
+             std::vector<int>* values) const;
+};
+
+/**
+ * Returns the index of the time ranges of the child layers of the composition, on the timeline of
+ * the composition, with the child indices as values. Layers excluded from the timeline are always
+ * active. The indices are cached per composition and rebuilt when the content version changes,
+ * which every call that adds, removes or retimes a layer does.
+ */
+std::shared_ptr<JIntervalIndex> GetChildLayerIndex(std::shared_ptr<PAGComposition> composition);
+}  // namespace pag
@@ -17,12 +17,32 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "JNIHelper.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include "JPAGLayerHandle.h"
 
 extern "C" jint JNI_OnLoad(JavaVM* vm, void*) {
   LOGI("PAG JNI_OnLoad Version: %s", pag::PAG::SDKVersion().c_str());
+  JNIEnv* env = nullptr;
+  if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_4) != JNI_OK) {
+    return JNI_ERR;
+  }
+  // Superclasses are registered first, so that their field IDs are ready before the subclasses
+  // are loaded.
+  if (!pag::RegisterPAGNatives(env) || !pag::RegisterPAGLayerNatives(env) ||
+      !pag::RegisterPAGCompositionNatives(env) || !pag::RegisterPAGFileNatives(env) ||
+      !pag::RegisterPAGSurfaceNatives(env) || !pag::RegisterPAGPlayerNatives(env) ||
+      !pag::RegisterPAGCommandBufferNatives(env) || !pag::RegisterPAGAsyncReadbackNatives(env) ||
+      !pag::RegisterPAGSeekCacheNatives(env) || !pag::RegisterPAGFrameExporterNatives(env) ||
+      !pag::RegisterPAGFileLoaderNatives(env) || !pag::RegisterPAGStaticFramesNatives(env) ||
+      !pag::RegisterPAGRenderClientNatives(env) || !pag::RegisterPAGTiledRendererNatives(env) ||
+      !pag::RegisterPAGFrameFingerprintNatives(env) || !pag::RegisterPAGBakedFramesNatives(env)) {
+    return JNI_ERR;
+  }
   return JNI_VERSION_1_4;
 }
 
@@ -31,6 +51,22 @@ extern "C" void JNI_OnUnload(JavaVM*, void*) {
 }
 
 namespace pag {
+jclass RegisterNativeMethods(JNIEnv* env, const char* className, const JNINativeMethod* methods,
+                             int numMethods) {
+  auto clazz = env->FindClass(className);
+  if (clazz == nullptr) {
+    env->ExceptionClear();
+    LOGE("Could not register natives, %s is not found!", className);
+    return nullptr;
+  }
+  if (env->RegisterNatives(clazz, methods, numMethods) != JNI_OK) {
+    env->ExceptionClear();
+    LOGE("Could not register natives of %s!", className);
+    return nullptr;
+  }
+  return clazz;
+}
+
 jobject MakeRectFObject(JNIEnv* env, float x, float y, float width, float height) {
   jclass RectFClass = env->FindClass("org/libpag/PAGRect");
   if (RectFClass == nullptr) {
@@ -101,4 +137,73 @@ std::shared_ptr<pag::PAGComposition> ToPAGCompositionNativeObject(JNIEnv* env,
 
   return std::static_pointer_cast<pag::PAGComposition>(nativeContext->get());
 }
+
+struct TreeVersion {
+  std::weak_ptr<pag::PAGLayer> root;
+  uint64_t version = 0;
+};
+
+static std::mutex versionLocker = {};
+static std::unordered_map<pag::ID, TreeVersion> treeVersions = {};
+static uint64_t lastVersion = 0;
+static size_t pruneThreshold = 64;
+
+static std::shared_ptr<pag::PAGLayer> RootOf(std::shared_ptr<pag::PAGLayer> layer) {
+  std::shared_ptr<pag::PAGLayer> root = layer;
+  while (auto parent = root->parent()) {
+    root = parent;
+  }
+  return root;
+}
+
+void MarkContentChanged(std::shared_ptr<pag::PAGLayer> layer) {
+  if (layer == nullptr) {
+    return;
+  }
+  auto root = RootOf(layer);
+  std::lock_guard<std::mutex> autoLock(versionLocker);
+  treeVersions[root->uniqueID()] = {root, ++lastVersion};
+  if (treeVersions.size() < pruneThreshold) {
+    return;
+  }
+  for (auto item = treeVersions.begin(); item != treeVersions.end();) {
+    if (item->second.root.expired()) {
+      item = treeVersions.erase(item);
+    } else {
+      ++item;
+    }
+  }
+  pruneThreshold = std::max<size_t>(64, treeVersions.size() * 2);
+}
+
+uint64_t ContentVersion(std::shared_ptr<pag::PAGLayer> layer) {
+  if (layer == nullptr) {
+    return 0;
+  }
+  auto root = RootOf(layer);
+  std::lock_guard<std::mutex> autoLock(versionLocker);
+  auto result = treeVersions.find(root->uniqueID());
+  return result != treeVersions.end() ? result->second.version : 0;
+}
+
+int64_t CountFrames(std::shared_ptr<pag::PAGComposition> composition) {
+  if (composition == nullptr) {
+    return 1;
+  }
+  return CountFrames(composition->duration(), composition->frameRate());
+}
+
+int64_t CountFrames(int64_t duration, float frameRate) {
+  return std::max<int64_t>(1, static_cast<int64_t>(std::floor(duration * frameRate / 1000000.0)));
+}
+
+double FrameToProgress(int64_t frame, int64_t totalFrames) {
+  if (totalFrames <= 1 || frame <= 0) {
+    return 0;
+  }
+  if (frame >= totalFrames - 1) {
+    return 1;
+  }
+  return (static_cast<double>(frame) + 0.1) / static_cast<double>(totalFrames);
+}
 }  // namespace pag
@@ -24,6 +24,33 @@
 #include "JStringUtil.h"
 
 namespace pag {
+/**
+ * Finds the class and binds the native methods to it, returns nullptr if either step fails.
+ */
+jclass RegisterNativeMethods(JNIEnv* env, const char* className, const JNINativeMethod* methods,
+                             int numMethods);
+
+/**
+ * Registers the native methods of each Java class and caches its field IDs. They are all called
+ * from JNI_OnLoad, every new native method must be added to the table of its file.
+ */
+bool RegisterPAGNatives(JNIEnv* env);
+bool RegisterPAGLayerNatives(JNIEnv* env);
+bool RegisterPAGCompositionNatives(JNIEnv* env);
+bool RegisterPAGFileNatives(JNIEnv* env);
+bool RegisterPAGSurfaceNatives(JNIEnv* env);
+bool RegisterPAGPlayerNatives(JNIEnv* env);
+bool RegisterPAGCommandBufferNatives(JNIEnv* env);
+bool RegisterPAGAsyncReadbackNatives(JNIEnv* env);
+bool RegisterPAGSeekCacheNatives(JNIEnv* env);
+bool RegisterPAGFrameExporterNatives(JNIEnv* env);
+bool RegisterPAGFileLoaderNatives(JNIEnv* env);
+bool RegisterPAGStaticFramesNatives(JNIEnv* env);
+bool RegisterPAGRenderClientNatives(JNIEnv* env);
+bool RegisterPAGTiledRendererNatives(JNIEnv* env);
+bool RegisterPAGFrameFingerprintNatives(JNIEnv* env);
+bool RegisterPAGBakedFramesNatives(JNIEnv* env);
+
 jobject MakeRectFObject(JNIEnv* env, float x, float y, float width, float height);
 
 jobject ToPAGLayerJavaObject(JNIEnv* env, std::shared_ptr<pag::PAGLayer> pagLayer);
@@ -32,4 +59,33 @@ std::shared_ptr<pag::PAGLayer> ToPAGLayerNativeObject(JNIEnv* env, jobject jLaye
 
 std::shared_ptr<pag::PAGComposition> ToPAGCompositionNativeObject(JNIEnv* env,
                                                                   jobject jComposition);
+
+/**
+ * Marks that the layer tree containing the layer has been edited through the bindings. Every tree
+ * is versioned on its own, keyed on its root layer, so edits to one tree leave the caches of the
+ * others valid. Must be called after the edit, for a moved layer both before and after the move.
+ */
+void MarkContentChanged(std::shared_ptr<pag::PAGLayer> layer);
+
+/**
+ * Returns the version of the layer tree containing the layer, or 0 if that tree has never been
+ * edited. Versions are unique across all trees, a layer moved to another tree never reports a
+ * version it had before.
+ */
+uint64_t ContentVersion(std::shared_ptr<pag::PAGLayer> layer);
+
+/**
+ * Returns the number of frames in the composition, which is at least 1.
+ */
+int64_t CountFrames(std::shared_ptr<pag::PAGComposition> composition);
+
+/**
+ * Returns the number of frames of content with the duration in microseconds and the frame rate.
+ */
+int64_t CountFrames(int64_t duration, float frameRate);
+
+/**
+ * Returns the progress that makes a PAGPlayer display the specified frame.
+ */
+double FrameToProgress(int64_t frame, int64_t totalFrames);
 }  // namespace pag
\ No newline at end of file
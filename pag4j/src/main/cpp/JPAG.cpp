@@ -17,8 +17,95 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "JNIHelper.h"
+#include "JPAGSurface.h"
+#include "JTrace.h"
 #include "pag/pag.h"
 
 extern "C" JNIEXPORT jstring JNICALL Java_org_libpag_PAG_SDKVersion(JNIEnv* env, jclass) {
   return pag::SafeConvertToJString(env, pag::PAG::SDKVersion());
 }
+
+extern "C" JNIEXPORT jlong JNICALL Java_org_libpag_PAG_nativePrewarm(JNIEnv* env, jclass,
+                                                                     jstring samplePath,
+                                                                     jint width, jint height) {
+  PAG4J_TRACE_EVENT("jni", "PAG.nativePrewarm");
+  auto surface = pag::PAGSurface::MakeOffscreen(width, height);
+  if (surface == nullptr) {
+    LOGE("PAG.prewarm(): Failed to create a offscreen PAGSurface!");
+    return 0;
+  }
+  auto player = std::make_shared<pag::PAGPlayer>();
+  player->setSurface(surface);
+  std::shared_ptr<pag::PAGComposition> composition = nullptr;
+  auto path = pag::SafeConvertToStdString(env, samplePath);
+  if (!path.empty()) {
+    PAG4J_TRACE_EVENT("pag", "PAGFile::Load");
+    composition = pag::PAGFile::Load(path);
+    if (composition == nullptr) {
+      LOGE("PAG.prewarm() Invalid pag file : %s", path.c_str());
+    }
+  }
+  if (composition == nullptr) {
+    composition = pag::PAGComposition::Make(width, height);
+  }
+  player->setComposition(composition);
+  // Rendering two distant frames touches most of the layers, and thereby the fonts, decoders
+  // and shader programs the sample requires.
+  for (auto progress : {0.0, 0.5}) {
+    player->setProgress(progress);
+    player->prepare();
+    player->flush();
+  }
+  std::vector<uint8_t> pixels(static_cast<size_t>(surface->width()) * surface->height() * 4);
+  surface->readPixels(pag::ColorType::RGBA_8888, pag::AlphaType::Premultiplied, pixels.data(),
+                      static_cast<size_t>(surface->width()) * 4);
+  player->setComposition(nullptr);
+  player->setSurface(nullptr);
+  return reinterpret_cast<jlong>(new JPAGSurface(surface));
+}
+
+extern "C" JNIEXPORT void JNICALL Java_org_libpag_PAG_startTracing(JNIEnv*, jclass,
+                                                                  jint bufferSize) {
+  pag::JTrace::Start(bufferSize);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_org_libpag_PAG_stopTracing(JNIEnv*, jclass) {
+  pag::JTrace::Stop();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_org_libpag_PAG_isTracing(JNIEnv*, jclass) {
+  return static_cast<jboolean>(pag::JTrace::IsEnabled());
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_org_libpag_PAG_traceToJSON(JNIEnv* env, jclass) {
+  return pag::SafeConvertToJString(env, pag::JTrace::ToJSON());
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_org_libpag_PAG_writeTrace(JNIEnv* env, jclass,
+                                                                    jstring path) {
+  auto filePath = pag::SafeConvertToStdString(env, path);
+  if (filePath.empty()) {
+    return JNI_FALSE;
+  }
+  return static_cast<jboolean>(pag::JTrace::WriteToFile(filePath));
+}
+
+static JNINativeMethod PAG_methods[] = {
+    {"SDKVersion", "()Ljava/lang/String;", reinterpret_cast<void*>(Java_org_libpag_PAG_SDKVersion)},
+    {"nativePrewarm", "(Ljava/lang/String;II)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAG_nativePrewarm)},
+    {"startTracing", "(I)V", reinterpret_cast<void*>(Java_org_libpag_PAG_startTracing)},
+    {"stopTracing", "()V", reinterpret_cast<void*>(Java_org_libpag_PAG_stopTracing)},
+    {"isTracing", "()Z", reinterpret_cast<void*>(Java_org_libpag_PAG_isTracing)},
+    {"traceToJSON", "()Ljava/lang/String;",
+     reinterpret_cast<void*>(Java_org_libpag_PAG_traceToJSON)},
+    {"writeTrace", "(Ljava/lang/String;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAG_writeTrace)},
+};
+
+namespace pag {
+bool RegisterPAGNatives(JNIEnv* env) {
+  return RegisterNativeMethods(env, "org/libpag/PAG", PAG_methods,
+                               sizeof(PAG_methods) / sizeof(JNINativeMethod)) != nullptr;
+}
+}  // namespace pag
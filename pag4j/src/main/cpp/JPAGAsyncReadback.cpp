@@ -0,0 +1,279 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JPAGAsyncReadback.h"
+#include "JNIHelper.h"
+#include "JPAGPlayer.h"
+#include "JTrace.h"
+
+using namespace pag;
+
+std::unique_ptr<JPAGAsyncReadback> JPAGAsyncReadback::Make(int width, int height) {
+  if (width <= 0 || height <= 0) {
+    return nullptr;
+  }
+  std::unique_ptr<JPAGAsyncReadback> readback(new JPAGAsyncReadback(width, height));
+  readback->surface = PAGSurface::MakeOffscreen(width, height);
+  if (readback->surface == nullptr) {
+    return nullptr;
+  }
+  auto byteCount = static_cast<size_t>(width) * height * 4;
+  readback->readBuffer = std::make_shared<std::vector<uint8_t>>(byteCount);
+  readback->readThread = std::thread(&JPAGAsyncReadback::readLoop, readback.get());
+  return readback;
+}
+
+JPAGAsyncReadback::~JPAGAsyncReadback() {
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    exiting = true;
+  }
+  condition.notify_all();
+  if (readThread.joinable()) {
+    readThread.join();
+  }
+}
+
+bool JPAGAsyncReadback::renderFrame(std::shared_ptr<PAGPlayer> player) {
+  if (player == nullptr) {
+    return false;
+  }
+  // The player keeps rendering into the same surface, so it is attached only once and its caches
+  // stay on the same GPU device.
+  if (player->getSurface() != surface) {
+    player->setSurface(surface);
+  }
+  auto job = std::unique_ptr<ReadJob>(new ReadJob());
+  job->player = player;
+  {
+    // The surface holds a single frame, the previous one must be read back before it is redrawn.
+    std::unique_lock<std::mutex> autoLock(locker);
+    waitForReadback(autoLock);
+    job->frame = frameCount++;
+  }
+  bool changed = false;
+  {
+    PAG4J_TRACE_EVENT("pag", "PAGPlayer::flushAndSignalSemaphore");
+    changed = player->flushAndSignalSemaphore(&job->semaphore);
+  }
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    pendingJob = std::move(job);
+  }
+  condition.notify_all();
+  return changed;
+}
+
+void JPAGAsyncReadback::finish(std::shared_ptr<PAGPlayer> player) {
+  {
+    std::unique_lock<std::mutex> autoLock(locker);
+    waitForReadback(autoLock);
+  }
+  if (player != nullptr && player->getSurface() == surface) {
+    player->setSurface(nullptr);
+  }
+}
+
+std::shared_ptr<const std::vector<uint8_t>> JPAGAsyncReadback::latestFrame(int64_t* frame) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  *frame = latestFrameIndex;
+  return latestPixels;
+}
+
+void JPAGAsyncReadback::waitForReadback(std::unique_lock<std::mutex>& autoLock) {
+  condition.wait(autoLock, [&] { return pendingJob == nullptr && !reading; });
+}
+
+void JPAGAsyncReadback::readLoop() {
+  JTrace::SetThreadName("PAGAsyncReadback");
+  auto rowBytes = static_cast<size_t>(_width) * 4;
+  while (true) {
+    std::unique_ptr<ReadJob> job = nullptr;
+    std::shared_ptr<std::vector<uint8_t>> pixels = nullptr;
+    {
+      std::unique_lock<std::mutex> autoLock(locker);
+      condition.wait(autoLock, [&] { return exiting || pendingJob != nullptr; });
+      if (exiting) {
+        return;
+      }
+      job = std::move(pendingJob);
+      pixels = readBuffer;
+      reading = true;
+    }
+    bool success = false;
+    {
+      PAG4J_TRACE_EVENT("pag", "PAGSurface::readPixels");
+      // Waits on the fence signaled by the flush before reading the frame back. The wait fails
+      // only if the player has been detached in between, the readback then synchronizes itself.
+      if (job->semaphore.isInitialized()) {
+        job->player->wait(job->semaphore);
+      }
+      success = surface->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied,
+                                    pixels->data(), rowBytes);
+    }
+    job->player = nullptr;
+    {
+      std::lock_guard<std::mutex> autoLock(locker);
+      if (success) {
+        readBuffer.swap(latestPixels);
+        latestFrameIndex = job->frame;
+        // Callers may still be copying from the buffer that was published before, it is never
+        // written again while they hold it.
+        if (readBuffer == nullptr || readBuffer.use_count() > 1) {
+          readBuffer = std::make_shared<std::vector<uint8_t>>(pixels->size());
+        }
+      }
+      reading = false;
+    }
+    condition.notify_all();
+  }
+}
+
+namespace pag {
+static jfieldID PAGAsyncReadback_nativeContext;
+}
+
+static JPAGAsyncReadback* GetAsyncReadback(JNIEnv* env, jobject thiz) {
+  return reinterpret_cast<JPAGAsyncReadback*>(
+      env->GetLongField(thiz, PAGAsyncReadback_nativeContext));
+}
+
+static std::shared_ptr<PAGPlayer> ToPAGPlayer(JPAGPlayer* jPlayer) {
+  if (jPlayer == nullptr) {
+    return nullptr;
+  }
+  return jPlayer->get();
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGAsyncReadback_SetupReadback(JNIEnv*, jclass,
+                                                                       jint width, jint height) {
+  PAG4J_TRACE_EVENT("jni", "PAGAsyncReadback.SetupReadback");
+  auto readback = JPAGAsyncReadback::Make(width, height);
+  if (readback == nullptr) {
+    LOGE("PAGAsyncReadback.SetupReadback(): Failed to create the offscreen surface!");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(readback.release());
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGAsyncReadback_nativeRelease(JNIEnv* env, jobject thiz) {
+  delete GetAsyncReadback(env, thiz);
+  env->SetLongField(thiz, PAGAsyncReadback_nativeContext, 0);
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGAsyncReadback_width(JNIEnv* env, jobject thiz) {
+  auto readback = GetAsyncReadback(env, thiz);
+  return readback != nullptr ? readback->width() : 0;
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGAsyncReadback_height(JNIEnv* env, jobject thiz) {
+  auto readback = GetAsyncReadback(env, thiz);
+  return readback != nullptr ? readback->height() : 0;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGAsyncReadback_nativeRenderFrame(
+    JNIEnv* env, jobject thiz, jobject playerObject) {
+  PAG4J_TRACE_EVENT("jni", "PAGAsyncReadback.nativeRenderFrame");
+  auto readback = GetAsyncReadback(env, thiz);
+  if (readback == nullptr || playerObject == nullptr) {
+    return JNI_FALSE;
+  }
+  // The player object is an argument of this call, so its finalizer can not run meanwhile.
+  auto jPlayer = getJPAGPlayer(env, playerObject);
+  if (jPlayer != nullptr) {
+    // The readback draws past the player's static frame tracking, its next flush must not be
+    // skipped.
+    std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+    jPlayer->lastFlushedFrame = -1;
+  }
+  return static_cast<jboolean>(readback->renderFrame(ToPAGPlayer(jPlayer)));
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGAsyncReadback_nativeFinish(JNIEnv* env, jobject thiz,
+                                                                    jobject playerObject) {
+  PAG4J_TRACE_EVENT("jni", "PAGAsyncReadback.nativeFinish");
+  auto readback = GetAsyncReadback(env, thiz);
+  if (readback == nullptr) {
+    return;
+  }
+  auto jPlayer = playerObject != nullptr ? getJPAGPlayer(env, playerObject) : nullptr;
+  readback->finish(ToPAGPlayer(jPlayer));
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGAsyncReadback_copyLatestFrameTo(JNIEnv* env,
+                                                                          jobject thiz,
+                                                                          jbyteArray pixels,
+                                                                          jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGAsyncReadback.copyLatestFrameTo");
+  auto readback = GetAsyncReadback(env, thiz);
+  if (readback == nullptr || pixels == nullptr) {
+    return -1;
+  }
+  auto width = readback->width();
+  auto height = readback->height();
+  auto rowBytes = width * 4;
+  if (stride < rowBytes ||
+      env->GetArrayLength(pixels) < static_cast<jlong>(stride) * (height - 1) + rowBytes) {
+    return -1;
+  }
+  int64_t frame = -1;
+  // The published buffer is immutable, so the copy into the Java array runs without the lock.
+  auto source = readback->latestFrame(&frame);
+  if (source == nullptr) {
+    return -1;
+  }
+  auto bytes = reinterpret_cast<const jbyte*>(source->data());
+  if (stride == rowBytes) {
+    env->SetByteArrayRegion(pixels, 0, rowBytes * height, bytes);
+    return frame;
+  }
+  for (int row = 0; row < height; row++) {
+    env->SetByteArrayRegion(pixels, row * stride, rowBytes, bytes + row * rowBytes);
+  }
+  return frame;
+}
+}
+
+static JNINativeMethod PAGAsyncReadback_methods[] = {
+    {"SetupReadback", "(II)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGAsyncReadback_SetupReadback)},
+    {"width", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGAsyncReadback_width)},
+    {"height", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGAsyncReadback_height)},
+    {"nativeRenderFrame", "(Lorg/libpag/PAGPlayer;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGAsyncReadback_nativeRenderFrame)},
+    {"nativeFinish", "(Lorg/libpag/PAGPlayer;)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGAsyncReadback_nativeFinish)},
+    {"copyLatestFrameTo", "([BI)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGAsyncReadback_copyLatestFrameTo)},
+    {"nativeRelease", "()V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGAsyncReadback_nativeRelease)},
+};
+
+namespace pag {
+bool RegisterPAGAsyncReadbackNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGAsyncReadback", PAGAsyncReadback_methods,
+                                     sizeof(PAGAsyncReadback_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGAsyncReadback_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
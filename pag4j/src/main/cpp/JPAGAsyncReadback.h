@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pag/pag.h"
+
+/**
+ * Moves the pixel readback of rendered frames off the calling thread. PAGPlayer renders into a
+ * single offscreen surface and signals a fence after each flush, a worker thread waits on that
+ * fence and reads the pixels back into a CPU buffer while the caller goes on with its own work.
+ * The readback of a frame never overlaps the rendering of the next one, since both use the same
+ * surface: renderFrame() waits for the previous readback first. Rendering stays on one GPU
+ * device, so the graphics caches of the player survive between frames.
+ */
+class JPAGAsyncReadback {
+ public:
+  static std::unique_ptr<JPAGAsyncReadback> Make(int width, int height);
+
+  ~JPAGAsyncReadback();
+
+  int width() const {
+    return _width;
+  }
+
+  int height() const {
+    return _height;
+  }
+
+  /**
+   * Waits until the previous frame has been read back, renders the current progress of the player
+   * and queues the new frame for readback. Returns the result of PAGPlayer::flush().
+   */
+  bool renderFrame(std::shared_ptr<pag::PAGPlayer> player);
+
+  /**
+   * Detaches the player from the surface and waits until the pending readback is completed.
+   */
+  void finish(std::shared_ptr<pag::PAGPlayer> player);
+
+  /**
+   * Returns the pixels of the latest completed frame, which are tightly packed RGBA rows, and sets
+   * frame to its sequence number, or returns nullptr and sets frame to -1 if no frame has
+   * completed. The returned buffer is never written again, so it can be read without holding
+   * the lock.
+   */
+  std::shared_ptr<const std::vector<uint8_t>> latestFrame(int64_t* frame);
+
+ private:
+  struct ReadJob {
+    std::shared_ptr<pag::PAGPlayer> player = nullptr;
+    pag::BackendSemaphore semaphore = {};
+    int64_t frame = -1;
+  };
+
+  int _width = 0;
+  int _height = 0;
+  std::shared_ptr<pag::PAGSurface> surface = nullptr;
+  int64_t frameCount = 0;
+  std::unique_ptr<ReadJob> pendingJob = nullptr;
+  bool reading = false;
+  std::shared_ptr<std::vector<uint8_t>> readBuffer = nullptr;
+  std::shared_ptr<std::vector<uint8_t>> latestPixels = nullptr;
+  int64_t latestFrameIndex = -1;
+  bool exiting = false;
+  std::mutex locker = {};
+  std::condition_variable condition = {};
+  std::thread readThread = {};
+
+  JPAGAsyncReadback(int width, int height) : _width(width), _height(height) {
+  }
+
+  void waitForReadback(std::unique_lock<std::mutex>& autoLock);
+  void readLoop();
+};
@@ -0,0 +1,215 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JBakeFormat.h"
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+namespace pag {
+static jfieldID PAGBakedFrames_nativeContext;
+}
+
+using namespace pag;
+
+static std::shared_ptr<JBakedFrames> GetBakedFrames(JNIEnv* env, jobject thiz) {
+  auto handle = reinterpret_cast<std::shared_ptr<JBakedFrames>*>(
+      env->GetLongField(thiz, PAGBakedFrames_nativeContext));
+  return handle != nullptr ? *handle : nullptr;
+}
+
+static jobject MakeBakeReportObject(JNIEnv* env, const BakeReport& report) {
+  jclass ReportClass = env->FindClass("org/libpag/PAGBakeReport");
+  jclass StringClass = env->FindClass("java/lang/String");
+  if (ReportClass == nullptr || StringClass == nullptr) {
+    env->ExceptionClear();
+    LOGE("PAGBakedFrames.Bake(): PAGBakeReport is not found!");
+    return nullptr;
+  }
+  auto count = static_cast<jsize>(report.layers.size());
+  auto names = env->NewObjectArray(count, StringClass, nullptr);
+  auto types = env->NewIntArray(count);
+  auto live = env->NewBooleanArray(count);
+  auto baked = env->NewBooleanArray(count);
+  auto costs = env->NewLongArray(count);
+  if (names == nullptr || types == nullptr || live == nullptr || baked == nullptr ||
+      costs == nullptr) {
+    return nullptr;
+  }
+  for (jsize i = 0; i < count; i++) {
+    auto& layer = report.layers[i];
+    auto name = SafeConvertToJString(env, layer.name);
+    env->SetObjectArrayElement(names, i, name);
+    env->DeleteLocalRef(name);
+    auto type = static_cast<jint>(layer.type);
+    auto isLive = static_cast<jboolean>(layer.live);
+    auto isBaked = static_cast<jboolean>(layer.baked);
+    auto cost = static_cast<jlong>(layer.cost);
+    env->SetIntArrayRegion(types, i, 1, &type);
+    env->SetBooleanArrayRegion(live, i, 1, &isLive);
+    env->SetBooleanArrayRegion(baked, i, 1, &isBaked);
+    env->SetLongArrayRegion(costs, i, 1, &cost);
+  }
+  auto ReportConstructID = env->GetMethodID(
+      ReportClass, "<init>", "(ZIIJJJJJ[Ljava/lang/String;[I[Z[Z[J)V");
+  return env->NewObject(ReportClass, ReportConstructID, static_cast<jboolean>(report.baked),
+                        report.width, report.height, report.numFrames, report.uniqueFrames,
+                        report.bakedBytes, report.frameCost, report.readCost, names, types,
+                        live, baked, costs);
+}
+
+static jboolean DrawFrame(JNIEnv* env, jobject thiz, jlong frame, jbyteArray pixels, jint stride,
+                          bool beneath) {
+  auto frames = GetBakedFrames(env, thiz);
+  if (frames == nullptr || pixels == nullptr) {
+    return JNI_FALSE;
+  }
+  auto width = frames->width();
+  auto height = frames->height();
+  // The size comes from a file on disk, it is checked in 64 bits so that it can not wrap.
+  auto rowBytes = static_cast<jlong>(width) * 4;
+  if (stride < rowBytes ||
+      env->GetArrayLength(pixels) < static_cast<jlong>(stride) * (height - 1) + rowBytes) {
+    return JNI_FALSE;
+  }
+  auto pixelBuffer = env->GetByteArrayElements(pixels, nullptr);
+  if (pixelBuffer == nullptr) {
+    return JNI_FALSE;
+  }
+  auto success = beneath ? frames->compositeFrame(frame, pixelBuffer, static_cast<size_t>(stride))
+                         : frames->readFrame(frame, pixelBuffer, static_cast<size_t>(stride));
+  env->ReleaseByteArrayElements(pixels, pixelBuffer, success ? 0 : JNI_ABORT);
+  return static_cast<jboolean>(success);
+}
+
+extern "C" {
+
+JNIEXPORT jobject JNICALL Java_org_libpag_PAGBakedFrames_BakeFile(JNIEnv* env, jclass,
+                                                                  jobject pagFile, jfloat scale,
+                                                                  jstring pathObj) {
+  PAG4J_TRACE_EVENT("jni", "PAGBakedFrames.Bake");
+  auto composition = ToPAGCompositionNativeObject(env, pagFile);
+  auto path = SafeConvertToStdString(env, pathObj);
+  if (composition == nullptr || !composition->isPAGFile() || path.empty()) {
+    return nullptr;
+  }
+  BakeReport report = {};
+  if (!BakeFile(std::static_pointer_cast<PAGFile>(composition), scale, path, &report)) {
+    LOGE("PAGBakedFrames.Bake(): Failed to bake the PAGFile to %s", path.c_str());
+    return nullptr;
+  }
+  return MakeBakeReportObject(env, report);
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGBakedFrames_OpenFile(JNIEnv* env, jclass,
+                                                                jstring pathObj) {
+  PAG4J_TRACE_EVENT("jni", "PAGBakedFrames.Open");
+  auto path = SafeConvertToStdString(env, pathObj);
+  if (path.empty()) {
+    return 0;
+  }
+  auto frames = JBakedFrames::Open(path);
+  if (frames == nullptr) {
+    LOGE("PAGBakedFrames.Open(): Invalid baked file : %s", path.c_str());
+    return 0;
+  }
+  return reinterpret_cast<jlong>(new std::shared_ptr<JBakedFrames>(frames));
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGBakedFrames_nativeRelease(JNIEnv* env, jobject thiz) {
+  delete reinterpret_cast<std::shared_ptr<JBakedFrames>*>(
+      env->GetLongField(thiz, PAGBakedFrames_nativeContext));
+  env->SetLongField(thiz, PAGBakedFrames_nativeContext, 0);
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGBakedFrames_width(JNIEnv* env, jobject thiz) {
+  auto frames = GetBakedFrames(env, thiz);
+  return frames != nullptr ? frames->width() : 0;
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGBakedFrames_height(JNIEnv* env, jobject thiz) {
+  auto frames = GetBakedFrames(env, thiz);
+  return frames != nullptr ? frames->height() : 0;
+}
+
+JNIEXPORT jfloat JNICALL Java_org_libpag_PAGBakedFrames_frameRate(JNIEnv* env, jobject thiz) {
+  auto frames = GetBakedFrames(env, thiz);
+  return frames != nullptr ? frames->frameRate() : 0;
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGBakedFrames_numFrames(JNIEnv* env, jobject thiz) {
+  auto frames = GetBakedFrames(env, thiz);
+  return frames != nullptr ? frames->numFrames() : 0;
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGBakedFrames_numLayers(JNIEnv* env, jobject thiz) {
+  auto frames = GetBakedFrames(env, thiz);
+  return frames != nullptr ? frames->numLayers() : 0;
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGBakedFrames_bakedLayers(JNIEnv* env, jobject thiz) {
+  auto frames = GetBakedFrames(env, thiz);
+  return frames != nullptr ? frames->bakedLayers() : 0;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGBakedFrames_readFrame(JNIEnv* env, jobject thiz,
+                                                                   jlong frame, jbyteArray pixels,
+                                                                   jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGBakedFrames.readFrame");
+  return DrawFrame(env, thiz, frame, pixels, stride, false);
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGBakedFrames_compositeFrame(JNIEnv* env,
+                                                                        jobject thiz,
+                                                                        jlong frame,
+                                                                        jbyteArray pixels,
+                                                                        jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGBakedFrames.compositeFrame");
+  return DrawFrame(env, thiz, frame, pixels, stride, true);
+}
+}
+
+static JNINativeMethod PAGBakedFrames_methods[] = {
+    {"BakeFile", "(Lorg/libpag/PAGFile;FLjava/lang/String;)Lorg/libpag/PAGBakeReport;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_BakeFile)},
+    {"OpenFile", "(Ljava/lang/String;)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_OpenFile)},
+    {"width", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_width)},
+    {"height", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_height)},
+    {"frameRate", "()F", reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_frameRate)},
+    {"numFrames", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_numFrames)},
+    {"numLayers", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_numLayers)},
+    {"bakedLayers", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_bakedLayers)},
+    {"readFrame", "(J[BI)Z", reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_readFrame)},
+    {"compositeFrame", "(J[BI)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_compositeFrame)},
+    {"nativeRelease", "()V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGBakedFrames_nativeRelease)},
+};
+
+namespace pag {
+bool RegisterPAGBakedFramesNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGBakedFrames", PAGBakedFrames_methods,
+                                     sizeof(PAGBakedFrames_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGBakedFrames_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
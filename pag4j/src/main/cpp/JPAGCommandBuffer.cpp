@@ -0,0 +1,194 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "JNIHelper.h"
+#include "JPAGLayerHandle.h"
+#include "JTrace.h"
+
+using namespace pag;
+
+namespace {
+// Must be kept in sync with the opcodes in PAGCommandBuffer.java.
+enum CommandOp : jint {
+  OpSetMatrix = 1,
+  OpResetMatrix = 2,
+  OpSetVisible = 3,
+  OpSetStartTime = 4,
+  OpSetCurrentTime = 5,
+  OpSetProgress = 6,
+  OpSetLayerIndex = 7,
+};
+
+class CommandReader {
+ public:
+  CommandReader(const uint8_t* data, size_t size) : data(data), size(size) {
+  }
+
+  bool hasRemaining() const {
+    return position < size;
+  }
+
+  template <typename T>
+  bool read(T* value) {
+    if (size - position < sizeof(T)) {
+      return false;
+    }
+    memcpy(value, data + position, sizeof(T));
+    position += sizeof(T);
+    return true;
+  }
+
+ private:
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  size_t position = 0;
+};
+
+std::shared_ptr<PAGLayer> ToLayer(jlong handle) {
+  auto nativeContext = reinterpret_cast<JPAGLayerHandle*>(handle);
+  if (nativeContext == nullptr) {
+    return nullptr;
+  }
+  return nativeContext->get();
+}
+
+bool ApplyCommand(CommandReader* reader, jint op, const std::shared_ptr<PAGLayer>& pagLayer) {
+  switch (op) {
+    case OpSetMatrix: {
+      float values[9] = {};
+      if (!reader->read(&values)) {
+        return false;
+      }
+      if (pagLayer != nullptr) {
+        Matrix matrix = {};
+        matrix.set9(values);
+        pagLayer->setMatrix(matrix);
+      }
+      return true;
+    }
+    case OpResetMatrix:
+      if (pagLayer != nullptr) {
+        pagLayer->resetMatrix();
+      }
+      return true;
+    case OpSetVisible: {
+      jint visible = 0;
+      if (!reader->read(&visible)) {
+        return false;
+      }
+      if (pagLayer != nullptr) {
+        pagLayer->setVisible(visible != 0);
+      }
+      return true;
+    }
+    case OpSetStartTime:
+    case OpSetCurrentTime: {
+      jlong time = 0;
+      if (!reader->read(&time)) {
+        return false;
+      }
+      if (pagLayer != nullptr) {
+        if (op == OpSetStartTime) {
+          pagLayer->setStartTime(time);
+        } else {
+          pagLayer->setCurrentTime(time);
+        }
+      }
+      return true;
+    }
+    case OpSetProgress: {
+      jdouble progress = 0;
+      if (!reader->read(&progress)) {
+        return false;
+      }
+      if (pagLayer != nullptr) {
+        pagLayer->setProgress(progress);
+      }
+      return true;
+    }
+    case OpSetLayerIndex: {
+      jlong childHandle = 0;
+      jint index = 0;
+      if (!reader->read(&childHandle) || !reader->read(&index)) {
+        return false;
+      }
+      auto child = ToLayer(childHandle);
+      if (pagLayer != nullptr && child != nullptr &&
+          pagLayer->layerType() == LayerType::PreCompose) {
+        std::static_pointer_cast<PAGComposition>(pagLayer)->setLayerIndex(child, index);
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGCommandBuffer_nativeApply(JNIEnv* env, jclass,
+                                                                    jobject buffer, jint size) {
+  PAG4J_TRACE_EVENT("jni", "PAGCommandBuffer.nativeApply");
+  if (buffer == nullptr || size <= 0) {
+    return 0;
+  }
+  auto data = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+  auto capacity = env->GetDirectBufferCapacity(buffer);
+  if (data == nullptr || capacity < size) {
+    LOGE("PAGCommandBuffer.apply(): The command buffer is not a valid direct buffer!");
+    return 0;
+  }
+  CommandReader reader(data, static_cast<size_t>(size));
+  jint applied = 0;
+  std::vector<std::shared_ptr<PAGLayer>> changedLayers = {};
+  while (reader.hasRemaining()) {
+    jint op = 0;
+    jlong handle = 0;
+    if (!reader.read(&op) || !reader.read(&handle)) {
+      break;
+    }
+    auto pagLayer = ToLayer(handle);
+    if (!ApplyCommand(&reader, op, pagLayer)) {
+      LOGE("PAGCommandBuffer.apply(): Malformed command %d, the rest of the buffer is skipped.", op);
+      break;
+    }
+    if (pagLayer != nullptr && (changedLayers.empty() || changedLayers.back() != pagLayer)) {
+      changedLayers.push_back(pagLayer);
+    }
+    applied++;
+  }
+  for (auto& pagLayer : changedLayers) {
+    MarkContentChanged(pagLayer);
+  }
+  return applied;
+}
+}
+
+static JNINativeMethod PAGCommandBuffer_methods[] = {
+    {"nativeApply", "(Ljava/nio/ByteBuffer;I)I",
+     reinterpret_cast<void*>(Java_org_libpag_PAGCommandBuffer_nativeApply)},
+};
+
+namespace pag {
+bool RegisterPAGCommandBufferNatives(JNIEnv* env) {
+  return RegisterNativeMethods(env, "org/libpag/PAGCommandBuffer", PAGCommandBuffer_methods,
+                               sizeof(PAGCommandBuffer_methods) / sizeof(JNINativeMethod)) != nullptr;
+}
+}  // namespace pag
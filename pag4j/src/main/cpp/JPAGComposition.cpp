@@ -16,8 +16,11 @@
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include "JIntervalIndex.h"
 #include "JNIHelper.h"
 #include "JPAGLayerHandle.h"
+#include "JTrace.h"
 
 static jfieldID PAGComposition_nativeContext;
 
@@ -34,11 +37,8 @@ std::shared_ptr<PAGComposition> GetPAGComposition(JNIEnv* env, jobject thiz) {
 
 extern "C" {
 
-JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_nativeInit(JNIEnv* env, jclass clazz) {
-  PAGComposition_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
-}
-
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGComposition_Make(JNIEnv* env, jclass, jint width, jint height) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.Make");
   auto composition = PAGComposition::Make(width, height);
   if (composition == nullptr) {
     return nullptr;
@@ -64,11 +64,13 @@ JNIEXPORT jint JNICALL Java_org_libpag_PAGComposition_height(JNIEnv* env, jobjec
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_setContentSize(JNIEnv* env, jobject thiz, jint width,
                                                                      jint height) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.setContentSize");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return;
   }
   composition->setContentSize(width, height);
+  MarkContentChanged(composition);
 }
 
 JNIEXPORT jint JNICALL Java_org_libpag_PAGComposition_numChildren(JNIEnv* env, jobject thiz) {
@@ -111,6 +113,7 @@ JNIEXPORT jint JNICALL Java_org_libpag_PAGComposition_getLayerIndex(JNIEnv* env,
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_setLayerIndex(JNIEnv* env, jobject thiz, jobject layer,
                                                                     jint index) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.setLayerIndex");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return;
@@ -122,9 +125,11 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_setLayerIndex(JNIEnv* env,
   }
 
   composition->setLayerIndex(pagLayer, index);
+  MarkContentChanged(composition);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_addLayer(JNIEnv* env, jobject thiz, jobject layer) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.addLayer");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return;
@@ -133,11 +138,15 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_addLayer(JNIEnv* env, jobj
   if (pagLayer == nullptr) {
     return;
   }
+  // The layer leaves the tree it belonged to before.
+  MarkContentChanged(pagLayer);
   composition->addLayer(pagLayer);
+  MarkContentChanged(composition);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_addLayerAt(JNIEnv* env, jobject thiz, jobject layer,
                                                                  jint index) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.addLayerAt");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return;
@@ -146,7 +155,9 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_addLayerAt(JNIEnv* env, jo
   if (pagLayer == nullptr) {
     return;
   }
+  MarkContentChanged(pagLayer);
   composition->addLayerAt(pagLayer, index);
+  MarkContentChanged(composition);
 }
 
 JNIEXPORT jboolean JNICALL Java_org_libpag_PAGComposition_contains(JNIEnv* env, jobject thiz, jobject layer) {
@@ -163,6 +174,7 @@ JNIEXPORT jboolean JNICALL Java_org_libpag_PAGComposition_contains(JNIEnv* env,
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGComposition_removeLayer(JNIEnv* env, jobject thiz,
                                                                      jobject layer) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.removeLayer");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return nullptr;
@@ -171,28 +183,46 @@ JNIEXPORT jobject JNICALL Java_org_libpag_PAGComposition_removeLayer(JNIEnv* env
   if (pagLayer == nullptr) {
     return nullptr;
   }
-  return ToPAGLayerJavaObject(env, composition->removeLayer(pagLayer));
+  auto removedLayer = composition->removeLayer(pagLayer);
+  // The removed layer becomes the root of its own tree.
+  MarkContentChanged(composition);
+  MarkContentChanged(removedLayer);
+  return ToPAGLayerJavaObject(env, removedLayer);
 }
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGComposition_removeLayerAt(JNIEnv* env, jobject thiz,
                                                                        jint index) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.removeLayerAt");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return nullptr;
   }
-  return ToPAGLayerJavaObject(env, composition->removeLayerAt(index));
+  auto removedLayer = composition->removeLayerAt(index);
+  MarkContentChanged(composition);
+  MarkContentChanged(removedLayer);
+  return ToPAGLayerJavaObject(env, removedLayer);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_removeAllLayers(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.removeAllLayers");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return;
   }
+  std::vector<std::shared_ptr<PAGLayer>> removedLayers = {};
+  for (int i = 0; i < composition->numChildren(); i++) {
+    removedLayers.push_back(composition->getLayerAt(i));
+  }
   composition->removeAllLayers();
+  MarkContentChanged(composition);
+  for (auto& removedLayer : removedLayers) {
+    MarkContentChanged(removedLayer);
+  }
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_swapLayer(JNIEnv* env, jobject thiz, jobject layer1,
                                                                 jobject layer2) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.swapLayer");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return;
@@ -206,15 +236,18 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_swapLayer(JNIEnv* env, job
     return;
   }
   composition->swapLayer(pagLayer1, pagLayer2);
+  MarkContentChanged(composition);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGComposition_swapLayerAt(JNIEnv* env, jobject thiz, jint index1,
                                                                   jint index2) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.swapLayerAt");
   auto composition = GetPAGComposition(env, thiz);
   if (composition == nullptr) {
     return;
   }
   composition->swapLayerAt(index1, index2);
+  MarkContentChanged(composition);
 }
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGComposition_audioBytes(JNIEnv* env, jobject thiz) {
@@ -234,4 +267,74 @@ JNIEXPORT jlong JNICALL Java_org_libpag_PAGComposition_audioStartTime(JNIEnv* en
 
   return composition->audioStartTime();
 }
-}
\ No newline at end of file
+
+JNIEXPORT jintArray JNICALL Java_org_libpag_PAGComposition_getActiveLayerIndices(JNIEnv* env,
+                                                                                 jobject thiz,
+                                                                                 jlong time) {
+  PAG4J_TRACE_EVENT("jni", "PAGComposition.getActiveLayerIndices");
+  auto index = GetChildLayerIndex(GetPAGComposition(env, thiz));
+  if (index == nullptr) {
+    return nullptr;
+  }
+  std::vector<int> indices = {};
+  index->query(time, &indices);
+  // The query reports the layers by their start times, the callers expect the drawing order.
+  std::sort(indices.begin(), indices.end());
+  auto result = env->NewIntArray(static_cast<jsize>(indices.size()));
+  if (result == nullptr) {
+    return nullptr;
+  }
+  env->SetIntArrayRegion(result, 0, static_cast<jsize>(indices.size()),
+                         reinterpret_cast<const jint*>(indices.data()));
+  return result;
+}
+}
+
+static JNINativeMethod PAGComposition_methods[] = {
+    {"Make", "(II)Lorg/libpag/PAGComposition;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_Make)},
+    {"width", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGComposition_width)},
+    {"height", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGComposition_height)},
+    {"setContentSize", "(II)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_setContentSize)},
+    {"numChildren", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGComposition_numChildren)},
+    {"getLayerAt", "(I)Lorg/libpag/PAGLayer;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_getLayerAt)},
+    {"getLayerIndex", "(Lorg/libpag/PAGLayer;)I",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_getLayerIndex)},
+    {"setLayerIndex", "(Lorg/libpag/PAGLayer;I)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_setLayerIndex)},
+    {"addLayer", "(Lorg/libpag/PAGLayer;)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_addLayer)},
+    {"addLayerAt", "(Lorg/libpag/PAGLayer;I)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_addLayerAt)},
+    {"contains", "(Lorg/libpag/PAGLayer;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_contains)},
+    {"removeLayer", "(Lorg/libpag/PAGLayer;)Lorg/libpag/PAGLayer;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_removeLayer)},
+    {"removeLayerAt", "(I)Lorg/libpag/PAGLayer;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_removeLayerAt)},
+    {"removeAllLayers", "()V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_removeAllLayers)},
+    {"swapLayer", "(Lorg/libpag/PAGLayer;Lorg/libpag/PAGLayer;)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_swapLayer)},
+    {"swapLayerAt", "(II)V", reinterpret_cast<void*>(Java_org_libpag_PAGComposition_swapLayerAt)},
+    {"audioBytes", "()Ljava/nio/ByteBuffer;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_audioBytes)},
+    {"audioStartTime", "()J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_audioStartTime)},
+    {"getActiveLayerIndices", "(J)[I",
+     reinterpret_cast<void*>(Java_org_libpag_PAGComposition_getActiveLayerIndices)},
+};
+
+namespace pag {
+bool RegisterPAGCompositionNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGComposition", PAGComposition_methods,
+                                     sizeof(PAGComposition_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGComposition_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
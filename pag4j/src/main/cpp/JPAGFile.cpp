@@ -16,8 +16,13 @@
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include "JNIHelper.h"
+#include "JPAGFileProbe.h"
+#include "JPAGFileRegistry.h"
 #include "JPAGLayerHandle.h"
+#include "JThumbnailRenderer.h"
+#include "JTrace.h"
 
 namespace pag {
 static jfieldID PAGFile_nativeContext;
@@ -34,17 +39,37 @@ std::shared_ptr<pag::PAGFile> getPAGFile(JNIEnv* env, jobject thiz) {
   return std::static_pointer_cast<PAGFile>(nativeContext->get());
 }
 
-extern "C" {
-
-JNIEXPORT void JNICALL Java_org_libpag_PAGFile_nativeInit(JNIEnv* env, jclass clazz) {
-  PAGFile_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+static jobject MakeFileInfoObject(JNIEnv* env, const FileProbe& probe) {
+  auto& layerNames = probe.layerNames;
+  jclass StringClass = env->FindClass("java/lang/String");
+  auto names = env->NewObjectArray(static_cast<jsize>(layerNames.size()), StringClass, nullptr);
+  for (size_t i = 0; i < layerNames.size(); i++) {
+    auto name = SafeConvertToJString(env, layerNames[i]);
+    env->SetObjectArrayElement(names, static_cast<jsize>(i), name);
+    env->DeleteLocalRef(name);
+  }
+  jclass InfoClass = env->FindClass("org/libpag/PAGFileInfo");
+  if (InfoClass == nullptr) {
+    env->ExceptionClear();
+    LOGE("PAGFile.Probe(): PAGFileInfo is not found!");
+    return nullptr;
+  }
+  auto InfoConstructID = env->GetMethodID(InfoClass, "<init>", "(IIJFIIII[Ljava/lang/String;)V");
+  auto frameRate = probe.frameRate;
+  auto duration = frameRate > 0 ? static_cast<jlong>(probe.duration * 1000000.0 / frameRate) : 0;
+  return env->NewObject(InfoClass, InfoConstructID, probe.width, probe.height, duration, frameRate,
+                        static_cast<jint>(probe.tagLevel), probe.numTexts, probe.numImages,
+                        probe.numVideos, names);
 }
 
+extern "C" {
+
 JNIEXPORT jint JNICALL Java_org_libpag_PAGFile_MaxSupportedTagLevel(JNIEnv*, jclass) {
   return pag::PAGFile::MaxSupportedTagLevel();
 }
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_LoadFromPath(JNIEnv* env, jclass, jstring pathObj) {
+  PAG4J_TRACE_EVENT("jni", "PAGFile.LoadFromPath");
   if (pathObj == nullptr) {
     LOGE("PAGFile.LoadFromPath() Invalid path specified.");
     return NULL;
@@ -54,7 +79,11 @@ JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_LoadFromPath(JNIEnv* env, jcla
     return NULL;
   }
   LOGI("PAGFile.LoadFromPath() start: %s", path.c_str());
-  auto pagFile = PAGFile::Load(path);
+  std::shared_ptr<PAGFile> pagFile = nullptr;
+  {
+    PAG4J_TRACE_EVENT("pag", "PAGFile::Load");
+    pagFile = JPAGFileRegistry::GetInstance()->load(path);
+  }
   if (pagFile == nullptr) {
     LOGE("PAGFile.LoadFromPath() Invalid pag file : %s", path.c_str());
     return NULL;
@@ -64,13 +93,18 @@ JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_LoadFromPath(JNIEnv* env, jcla
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_LoadFromBytes(JNIEnv* env, jclass, jbyteArray bytes,
                                                       jint length, jstring jpath) {
+  PAG4J_TRACE_EVENT("jni", "PAGFile.LoadFromBytes");
   if (bytes == nullptr) {
     LOGE("PAGFile.LoadFromBytes() Invalid pag file bytes specified.");
     return NULL;
   }
   auto data = env->GetByteArrayElements(bytes, nullptr);
   auto path = SafeConvertToStdString(env, jpath);
-  auto pagFile = PAGFile::Load(data, static_cast<size_t>(length), path);
+  std::shared_ptr<PAGFile> pagFile = nullptr;
+  {
+    PAG4J_TRACE_EVENT("pag", "PAGFile::Load");
+    pagFile = JPAGFileRegistry::GetInstance()->load(data, static_cast<size_t>(length), path);
+  }
   env->ReleaseByteArrayElements(bytes, data, 0);
   if (pagFile == nullptr) {
     LOGE("PAGFile.LoadFromBytes() Invalid pag file bytes specified.");
@@ -134,17 +168,21 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGFile_setTimeStretchMode(JNIEnv* env, j
     return;
   }
   pagFile->setTimeStretchMode(static_cast<Enum>(mode));
+  MarkContentChanged(pagFile);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGFile_setDuration(JNIEnv* env, jobject thiz, jlong duration) {
+  PAG4J_TRACE_EVENT("jni", "PAGFile.setDuration");
   auto pagFile = getPAGFile(env, thiz);
   if (pagFile == nullptr) {
     return;
   }
   pagFile->setDuration(duration);
+  MarkContentChanged(pagFile);
 }
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_copyOriginal(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGFile.copyOriginal");
   auto pagFile = getPAGFile(env, thiz);
   if (pagFile == nullptr) {
     return NULL;
@@ -152,4 +190,115 @@ JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_copyOriginal(JNIEnv* env, jobj
   auto newFile = pagFile->copyOriginal();
   return ToPAGLayerJavaObject(env, newFile);
 }
-}
\ No newline at end of file
+
+JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_ProbeFromPath(JNIEnv* env, jclass,
+                                                                jstring pathObj) {
+  PAG4J_TRACE_EVENT("jni", "PAGFile.ProbeFromPath");
+  auto path = SafeConvertToStdString(env, pathObj);
+  FileProbe probe = {};
+  if (!ProbeFile(path, &probe)) {
+    return nullptr;
+  }
+  return MakeFileInfoObject(env, probe);
+}
+
+JNIEXPORT jobject JNICALL Java_org_libpag_PAGFile_ProbeFromBytes(JNIEnv* env, jclass,
+                                                                 jbyteArray bytes, jint length) {
+  PAG4J_TRACE_EVENT("jni", "PAGFile.ProbeFromBytes");
+  if (bytes == nullptr || length <= 0 || env->GetArrayLength(bytes) < length) {
+    return nullptr;
+  }
+  auto data = env->GetByteArrayElements(bytes, nullptr);
+  if (data == nullptr) {
+    return nullptr;
+  }
+  FileProbe probe = {};
+  auto result = ProbeFile(reinterpret_cast<uint8_t*>(data), static_cast<size_t>(length), &probe);
+  env->ReleaseByteArrayElements(bytes, data, JNI_ABORT);
+  if (!result) {
+    return nullptr;
+  }
+  return MakeFileInfoObject(env, probe);
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGFile_RenderThumbnailFromPath(
+    JNIEnv* env, jclass, jstring pathObj, jdouble progress, jint width, jint height,
+    jbyteArray pixels, jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGFile.RenderThumbnailFromPath");
+  auto path = SafeConvertToStdString(env, pathObj);
+  if (path.empty()) {
+    return JNI_FALSE;
+  }
+  std::shared_ptr<PAGFile> pagFile = nullptr;
+  {
+    PAG4J_TRACE_EVENT("pag", "PAGFile::Load");
+    pagFile = PAGFile::Load(path);
+  }
+  if (pagFile == nullptr) {
+    LOGE("PAGFile.RenderThumbnail() Invalid pag file : %s", path.c_str());
+    return JNI_FALSE;
+  }
+  return static_cast<jboolean>(JThumbnailRenderer::RenderToArray(env, pagFile, progress, width,
+                                                                 height, pixels, stride));
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGFile_SetContentSharing(JNIEnv*, jclass,
+                                                                 jboolean enabled) {
+  JPAGFileRegistry::GetInstance()->setEnabled(enabled);
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGFile_ContentSharingStats(JNIEnv* env, jclass,
+                                                                   jlongArray values) {
+  if (values == nullptr) {
+    return;
+  }
+  auto count = std::min<jsize>(env->GetArrayLength(values), 6);
+  int64_t stats[6] = {};
+  JPAGFileRegistry::GetInstance()->getStats(stats, count);
+  jlong result[6] = {};
+  std::copy(stats, stats + count, result);
+  env->SetLongArrayRegion(values, 0, count, result);
+}
+}
+
+static JNINativeMethod PAGFile_methods[] = {
+    {"MaxSupportedTagLevel", "()I",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_MaxSupportedTagLevel)},
+    {"RenderThumbnailFromPath", "(Ljava/lang/String;DII[BI)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_RenderThumbnailFromPath)},
+    {"ProbeFromPath", "(Ljava/lang/String;)Lorg/libpag/PAGFileInfo;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_ProbeFromPath)},
+    {"ProbeFromBytes", "([BI)Lorg/libpag/PAGFileInfo;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_ProbeFromBytes)},
+    {"SetContentSharing", "(Z)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_SetContentSharing)},
+    {"ContentSharingStats", "([J)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_ContentSharingStats)},
+    {"LoadFromPath", "(Ljava/lang/String;)Lorg/libpag/PAGFile;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_LoadFromPath)},
+    {"LoadFromBytes", "([BILjava/lang/String;)Lorg/libpag/PAGFile;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_LoadFromBytes)},
+    {"tagLevel", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGFile_tagLevel)},
+    {"numTexts", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGFile_numTexts)},
+    {"numImages", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGFile_numImages)},
+    {"numVideos", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGFile_numVideos)},
+    {"path", "()Ljava/lang/String;", reinterpret_cast<void*>(Java_org_libpag_PAGFile_path)},
+    {"timeStretchMode", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGFile_timeStretchMode)},
+    {"setTimeStretchMode", "(I)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_setTimeStretchMode)},
+    {"setDuration", "(J)V", reinterpret_cast<void*>(Java_org_libpag_PAGFile_setDuration)},
+    {"copyOriginal", "()Lorg/libpag/PAGFile;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFile_copyOriginal)},
+};
+
+namespace pag {
+bool RegisterPAGFileNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGFile", PAGFile_methods,
+                                     sizeof(PAGFile_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGFile_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
@@ -0,0 +1,172 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JPAGFileLoader.h"
+#include <algorithm>
+#include "JNIHelper.h"
+#include "JPAGFileRegistry.h"
+#include "JTrace.h"
+
+using namespace pag;
+
+JPAGFileLoader* JPAGFileLoader::GetInstance() {
+  // Never destroyed, the loader threads keep waiting for tasks until the process exits.
+  static auto loader = new JPAGFileLoader();
+  return loader;
+}
+
+JPAGFileLoader::JPAGFileLoader() {
+  auto threadCount = std::max(2u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < threadCount; i++) {
+    std::thread(&JPAGFileLoader::loadLoop, this).detach();
+  }
+}
+
+int64_t JPAGFileLoader::loadPath(std::string path) {
+  Task task = {};
+  task.path = std::move(path);
+  return addTask(std::move(task));
+}
+
+int64_t JPAGFileLoader::loadBytes(std::vector<uint8_t> bytes, std::string path) {
+  Task task = {};
+  task.bytes = std::move(bytes);
+  task.path = std::move(path);
+  task.fromBytes = true;
+  return addTask(std::move(task));
+}
+
+int64_t JPAGFileLoader::addTask(Task task) {
+  int64_t taskID = 0;
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    taskID = nextTaskID++;
+    task.id = taskID;
+    pendingTasks.push_back(std::move(task));
+  }
+  taskCondition.notify_one();
+  return taskID;
+}
+
+void JPAGFileLoader::cancel(int64_t taskID) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  auto result = std::find_if(pendingTasks.begin(), pendingTasks.end(),
+                             [taskID](const Task& task) { return task.id == taskID; });
+  if (result != pendingTasks.end()) {
+    pendingTasks.erase(result);
+  } else if (runningTasks.count(taskID) > 0) {
+    cancelledTasks.insert(taskID);
+  }
+}
+
+int64_t JPAGFileLoader::takeCompleted(std::shared_ptr<PAGFile>* file) {
+  std::unique_lock<std::mutex> autoLock(locker);
+  completionCondition.wait(autoLock, [this] { return !completions.empty(); });
+  auto completion = std::move(completions.front());
+  completions.pop_front();
+  *file = std::move(completion.file);
+  return completion.id;
+}
+
+void JPAGFileLoader::loadLoop() {
+  JTrace::SetThreadName("PAGFileLoader");
+  while (true) {
+    Task task = {};
+    {
+      std::unique_lock<std::mutex> autoLock(locker);
+      taskCondition.wait(autoLock, [this] { return !pendingTasks.empty(); });
+      task = std::move(pendingTasks.front());
+      pendingTasks.pop_front();
+      runningTasks.insert(task.id);
+    }
+    std::shared_ptr<PAGFile> file = nullptr;
+    {
+      PAG4J_TRACE_EVENT("pag", "PAGFile::Load");
+      if (task.fromBytes) {
+        file = JPAGFileRegistry::GetInstance()->load(task.bytes.data(), task.bytes.size(),
+                                                    task.path);
+      } else {
+        file = JPAGFileRegistry::GetInstance()->load(task.path);
+      }
+    }
+    if (file == nullptr) {
+      LOGE("PAGFile.LoadAsync() Invalid pag file : %s", task.path.c_str());
+    }
+    {
+      std::lock_guard<std::mutex> autoLock(locker);
+      runningTasks.erase(task.id);
+      if (cancelledTasks.erase(task.id) > 0) {
+        continue;
+      }
+      completions.push_back({task.id, std::move(file)});
+    }
+    completionCondition.notify_one();
+  }
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGFileLoader_nativeLoadFromPath(JNIEnv* env, jclass,
+                                                                         jstring path) {
+  return JPAGFileLoader::GetInstance()->loadPath(SafeConvertToStdString(env, path));
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGFileLoader_nativeLoadFromBytes(JNIEnv* env, jclass,
+                                                                          jbyteArray bytes,
+                                                                          jint limit,
+                                                                          jstring path) {
+  std::vector<uint8_t> data = {};
+  if (bytes != nullptr) {
+    auto length = std::min(limit, env->GetArrayLength(bytes));
+    data.resize(static_cast<size_t>(std::max(length, 0)));
+    env->GetByteArrayRegion(bytes, 0, static_cast<jsize>(data.size()),
+                            reinterpret_cast<jbyte*>(data.data()));
+  }
+  return JPAGFileLoader::GetInstance()->loadBytes(std::move(data),
+                                                  SafeConvertToStdString(env, path));
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGFileLoader_nativeCancel(JNIEnv*, jclass, jlong taskID) {
+  JPAGFileLoader::GetInstance()->cancel(taskID);
+}
+
+JNIEXPORT jobject JNICALL Java_org_libpag_PAGFileLoader_nativeTakeCompleted(JNIEnv* env, jclass,
+                                                                            jlongArray taskID) {
+  std::shared_ptr<PAGFile> file = nullptr;
+  jlong completedID = JPAGFileLoader::GetInstance()->takeCompleted(&file);
+  env->SetLongArrayRegion(taskID, 0, 1, &completedID);
+  return ToPAGLayerJavaObject(env, file);
+}
+}
+
+static JNINativeMethod PAGFileLoader_methods[] = {
+    {"nativeLoadFromPath", "(Ljava/lang/String;)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFileLoader_nativeLoadFromPath)},
+    {"nativeLoadFromBytes", "([BILjava/lang/String;)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFileLoader_nativeLoadFromBytes)},
+    {"nativeCancel", "(J)V", reinterpret_cast<void*>(Java_org_libpag_PAGFileLoader_nativeCancel)},
+    {"nativeTakeCompleted", "([J)Lorg/libpag/PAGFile;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFileLoader_nativeTakeCompleted)},
+};
+
+namespace pag {
+bool RegisterPAGFileLoaderNatives(JNIEnv* env) {
+  return RegisterNativeMethods(env, "org/libpag/PAGFileLoader", PAGFileLoader_methods,
+                               sizeof(PAGFileLoader_methods) / sizeof(JNINativeMethod)) != nullptr;
+}
+}  // namespace pag
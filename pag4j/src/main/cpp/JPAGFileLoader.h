@@ -0,0 +1,85 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <unordered_set>
+#include "pag/pag.h"
+
+/**
+ * Parses pag files on a pool of native threads. Finished loads are collected in a single queue,
+ * which is drained by one Java thread that converts the results and completes the futures.
+ */
+class JPAGFileLoader {
+ public:
+  /**
+   * Returns the process-wide loader. Its threads are started by the first call.
+   */
+  static JPAGFileLoader* GetInstance();
+
+  /**
+   * Queues loading the file at the path and returns the ID of the task.
+   */
+  int64_t loadPath(std::string path);
+
+  /**
+   * Queues parsing the bytes and returns the ID of the task.
+   */
+  int64_t loadBytes(std::vector<uint8_t> bytes, std::string path);
+
+  /**
+   * Cancels the task. A task that has not started yet is dropped, and the result of a running task
+   * is discarded when it finishes. Cancelled tasks never reach the completion queue.
+   */
+  void cancel(int64_t taskID);
+
+  /**
+   * Blocks until a task is finished and returns its ID. The file is nullptr if loading failed.
+   */
+  int64_t takeCompleted(std::shared_ptr<pag::PAGFile>* file);
+
+ private:
+  struct Task {
+    int64_t id = 0;
+    std::string path = {};
+    std::vector<uint8_t> bytes = {};
+    bool fromBytes = false;
+  };
+
+  struct Completion {
+    int64_t id = 0;
+    std::shared_ptr<pag::PAGFile> file = nullptr;
+  };
+
+  int64_t nextTaskID = 1;
+  std::deque<Task> pendingTasks = {};
+  std::unordered_set<int64_t> runningTasks = {};
+  std::unordered_set<int64_t> cancelledTasks = {};
+  std::deque<Completion> completions = {};
+  std::mutex locker = {};
+  std::condition_variable taskCondition = {};
+  std::condition_variable completionCondition = {};
+
+  JPAGFileLoader();
+
+  int64_t addTask(Task task);
+  void loadLoop();
+};
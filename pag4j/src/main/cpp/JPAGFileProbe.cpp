@@ -0,0 +1,478 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JPAGFileProbe.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "pag/file.h"
+
+namespace pag {
+// "PAG", the version, the body length and the compression method.
+static constexpr uint64_t FileHeaderSize = 9;
+// The tags read in full only hold a few attributes, a larger one means the data is corrupted.
+static constexpr uint32_t MaxContentSize = 1 << 20;
+
+// The file is little endian.
+static uint32_t ReadUint32(const uint8_t* bytes) {
+  return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+class ProbeSource {
+ public:
+  virtual ~ProbeSource() = default;
+
+  virtual uint64_t length() const = 0;
+
+  virtual bool read(uint64_t offset, void* buffer, size_t size) = 0;
+};
+
+class FileProbeSource : public ProbeSource {
+ public:
+  static std::unique_ptr<FileProbeSource> Open(const std::string& path) {
+    auto file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      return nullptr;
+    }
+    auto source = std::unique_ptr<FileProbeSource>(new FileProbeSource(file));
+    if (!source->seek(0, SEEK_END)) {
+      return nullptr;
+    }
+    source->_length = source->tell();
+    source->position = source->_length;
+    return source;
+  }
+
+  ~FileProbeSource() override {
+    fclose(file);
+  }
+
+  uint64_t length() const override {
+    return _length;
+  }
+
+  bool read(uint64_t offset, void* buffer, size_t size) override {
+    if (offset > _length || size > _length - offset) {
+      return false;
+    }
+    if (offset != position) {
+      if (!seek(offset, SEEK_SET)) {
+        return false;
+      }
+      position = offset;
+    }
+    if (fread(buffer, 1, size, file) != size) {
+      return false;
+    }
+    position += size;
+    return true;
+  }
+
+ private:
+  FILE* file = nullptr;
+  uint64_t _length = 0;
+  uint64_t position = 0;
+
+  explicit FileProbeSource(FILE* file) : file(file) {
+  }
+
+  // fseek() and ftell() take a long, which is 32 bits on Windows and ends at 2 GB.
+  bool seek(uint64_t offset, int origin) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), origin) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), origin) == 0;
+#endif
+  }
+
+  uint64_t tell() {
+#ifdef _WIN32
+    auto offset = _ftelli64(file);
+#else
+    auto offset = static_cast<int64_t>(ftello(file));
+#endif
+    return offset > 0 ? static_cast<uint64_t>(offset) : 0;
+  }
+};
+
+class DataProbeSource : public ProbeSource {
+ public:
+  DataProbeSource(const uint8_t* data, size_t length) : data(data), _length(length) {
+  }
+
+  uint64_t length() const override {
+    return _length;
+  }
+
+  bool read(uint64_t offset, void* buffer, size_t size) override {
+    if (offset > _length || size > _length - offset) {
+      return false;
+    }
+    memcpy(buffer, data + offset, size);
+    return true;
+  }
+
+ private:
+  const uint8_t* data = nullptr;
+  uint64_t _length = 0;
+};
+
+/**
+ * Decodes the values of a tag in the encodings of libpag's DecodeStream. Reading past the end
+ * returns zeros and marks the reader as failed.
+ */
+class TagReader {
+ public:
+  TagReader(const uint8_t* data, size_t length) : data(data), length(length) {
+  }
+
+  bool failed() const {
+    return _failed;
+  }
+
+  size_t position() const {
+    return _position;
+  }
+
+  uint8_t readUint8() {
+    if (_position >= length) {
+      _failed = true;
+      return 0;
+    }
+    return data[_position++];
+  }
+
+  uint64_t readEncodedUint64() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      auto byte = readUint8();
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    _failed = true;
+    return 0;
+  }
+
+  uint32_t readEncodedUint32() {
+    return static_cast<uint32_t>(readEncodedUint64());
+  }
+
+  // The lowest bit holds the sign.
+  int32_t readEncodedInt32() {
+    auto bits = readEncodedUint32();
+    auto value = static_cast<int32_t>(bits >> 1);
+    return (bits & 1) != 0 ? -value : value;
+  }
+
+  float readFloat() {
+    uint8_t bytes[4] = {};
+    for (auto& byte : bytes) {
+      byte = readUint8();
+    }
+    auto bits = ReadUint32(bytes);
+    float value = 0;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // The flags of an attribute block are packed from the lowest bit of the first byte on, and the
+  // values follow from the next whole byte.
+  std::vector<bool> readFlags(size_t count) {
+    std::vector<bool> flags(count, false);
+    for (size_t i = 0; i < count; i += 8) {
+      auto byte = readUint8();
+      for (size_t bit = 0; bit < 8 && i + bit < count; bit++) {
+        flags[i + bit] = (byte >> bit & 1) != 0;
+      }
+    }
+    return flags;
+  }
+
+  std::string readUTF8String() {
+    auto begin = data + std::min(_position, length);
+    auto end = std::find(begin, data + length, '\0');
+    if (end == data + length) {
+      _failed = true;
+      return "";
+    }
+    _position += static_cast<size_t>(end - begin) + 1;
+    return std::string(reinterpret_cast<const char*>(begin), static_cast<size_t>(end - begin));
+  }
+
+ private:
+  const uint8_t* data = nullptr;
+  size_t length = 0;
+  size_t _position = 0;
+  bool _failed = false;
+};
+
+struct ProbeLayer {
+  LayerType type = LayerType::Unknown;
+  std::string name = {};
+  // The image of an image layer or the composition of a precompose layer.
+  ID reference = 0;
+};
+
+struct ProbeComposition {
+  CompositionType type = CompositionType::Unknown;
+  int32_t width = 0;
+  int32_t height = 0;
+  int64_t duration = 0;
+  float frameRate = 0;
+  std::vector<ProbeLayer> layers = {};
+};
+
+struct ProbeTag {
+  TagCode code = TagCode::End;
+  uint64_t offset = 0;
+  uint32_t length = 0;
+};
+
+/**
+ * Walks the tags of a pag file. Every tag starts with a header holding its code and the length
+ * of its contents, so the tags not needed are skipped without being read.
+ */
+class TagWalker {
+ public:
+  explicit TagWalker(ProbeSource* source) : source(source) {
+  }
+
+  bool walkFile(FileProbe* probe) {
+    uint8_t header[FileHeaderSize] = {};
+    if (!source->read(0, header, FileHeaderSize) || header[0] != 'P' || header[1] != 'A' ||
+        header[2] != 'G') {
+      return false;
+    }
+    auto end = std::min(FileHeaderSize + ReadUint32(header + 4), source->length());
+    if (!walkTags(FileHeaderSize, end, [this](const ProbeTag& tag) { return readFileTag(tag); }) ||
+        compositions.empty()) {
+      return false;
+    }
+    auto& root = compositions[compositionOrder.back()];
+    probe->width = root.width;
+    probe->height = root.height;
+    probe->duration = root.duration;
+    probe->frameRate = root.frameRate;
+    probe->tagLevel = tagLevel;
+    std::unordered_set<ID> images = {};
+    for (auto& item : compositions) {
+      if (item.second.type == CompositionType::Video) {
+        probe->numVideos++;
+      }
+      for (auto& layer : item.second.layers) {
+        if (layer.type == LayerType::Text) {
+          probe->numTexts++;
+        } else if (layer.type == LayerType::Image) {
+          images.insert(layer.reference);
+        }
+      }
+    }
+    probe->numImages = static_cast<int>(images.size());
+    std::unordered_set<ID> visited = {};
+    collectLayerNames(compositionOrder.back(), &visited, &probe->layerNames);
+    return true;
+  }
+
+ private:
+  ProbeSource* source = nullptr;
+  uint16_t tagLevel = 0;
+  std::unordered_map<ID, ProbeComposition> compositions = {};
+  std::vector<ID> compositionOrder = {};
+
+  template <typename Visitor>
+  bool walkTags(uint64_t offset, uint64_t end, Visitor visitor) {
+    while (offset < end) {
+      uint8_t bytes[4] = {};
+      if (end - offset < 2 || !source->read(offset, bytes, 2)) {
+        return false;
+      }
+      offset += 2;
+      auto codeAndLength = static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+      ProbeTag tag = {};
+      tag.code = static_cast<TagCode>(codeAndLength >> 6);
+      tag.length = codeAndLength & 63;
+      if (tag.length == 63) {
+        if (end - offset < 4 || !source->read(offset, bytes, 4)) {
+          return false;
+        }
+        offset += 4;
+        tag.length = ReadUint32(bytes);
+      }
+      if (tag.length > end - offset) {
+        return false;
+      }
+      tag.offset = offset;
+      offset += tag.length;
+      tagLevel = std::max(tagLevel, static_cast<uint16_t>(codeAndLength >> 6));
+      if (tag.code == TagCode::End) {
+        return true;
+      }
+      if (!visitor(tag)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Reads at most the first maxLength bytes of the tag contents.
+  bool readPrefix(const ProbeTag& tag, size_t maxLength, std::vector<uint8_t>* content) {
+    auto length = std::min<size_t>(tag.length, maxLength);
+    content->resize(length);
+    return length == 0 || source->read(tag.offset, content->data(), length);
+  }
+
+  bool readContent(const ProbeTag& tag, std::vector<uint8_t>* content) {
+    return tag.length <= MaxContentSize && readPrefix(tag, tag.length, content);
+  }
+
+  bool readFileTag(const ProbeTag& tag) {
+    auto type = CompositionType::Unknown;
+    switch (tag.code) {
+      case TagCode::VectorCompositionBlock:
+        type = CompositionType::Vector;
+        break;
+      case TagCode::BitmapCompositionBlock:
+        type = CompositionType::Bitmap;
+        break;
+      case TagCode::VideoCompositionBlock:
+        type = CompositionType::Video;
+        break;
+      default:
+        return true;
+    }
+    // The id is followed by a boolean that tells whether a video composition has alpha.
+    std::vector<uint8_t> content = {};
+    if (!readPrefix(tag, 6, &content)) {
+      return false;
+    }
+    TagReader reader(content.data(), content.size());
+    auto id = reader.readEncodedUint32();
+    if (type == CompositionType::Video) {
+      reader.readUint8();
+    }
+    if (reader.failed()) {
+      return false;
+    }
+    if (compositions.count(id) == 0) {
+      compositionOrder.push_back(id);
+    }
+    auto composition = &compositions[id];
+    *composition = {};
+    composition->type = type;
+    return walkTags(tag.offset + reader.position(), tag.offset + tag.length,
+                    [this, composition](const ProbeTag& child) {
+                      return readCompositionTag(child, composition);
+                    });
+  }
+
+  bool readCompositionTag(const ProbeTag& tag, ProbeComposition* composition) {
+    if (tag.code == TagCode::CompositionAttributes) {
+      std::vector<uint8_t> content = {};
+      if (!readContent(tag, &content)) {
+        return false;
+      }
+      TagReader reader(content.data(), content.size());
+      composition->width = reader.readEncodedInt32();
+      composition->height = reader.readEncodedInt32();
+      composition->duration = static_cast<int64_t>(reader.readEncodedUint64());
+      composition->frameRate = reader.readFloat();
+      return !reader.failed();
+    }
+    if (tag.code != TagCode::LayerBlock || composition->type != CompositionType::Vector) {
+      return true;
+    }
+    // The layer type is followed by the layer id.
+    std::vector<uint8_t> content = {};
+    if (!readPrefix(tag, 6, &content)) {
+      return false;
+    }
+    TagReader reader(content.data(), content.size());
+    ProbeLayer layer = {};
+    layer.type = static_cast<LayerType>(reader.readUint8());
+    reader.readEncodedUint32();
+    if (reader.failed() ||
+        !walkTags(tag.offset + reader.position(), tag.offset + tag.length,
+                  [this, &layer](const ProbeTag& child) { return readLayerTag(child, &layer); })) {
+      return false;
+    }
+    composition->layers.push_back(std::move(layer));
+    return true;
+  }
+
+  bool readLayerTag(const ProbeTag& tag, ProbeLayer* layer) {
+    if (tag.code != TagCode::LayerAttributesExtra && tag.code != TagCode::ImageReference &&
+        tag.code != TagCode::CompositionReference) {
+      return true;
+    }
+    std::vector<uint8_t> content = {};
+    if (!readContent(tag, &content)) {
+      return false;
+    }
+    TagReader reader(content.data(), content.size());
+    if (tag.code == TagCode::LayerAttributesExtra) {
+      // The flags of the name and the motion blur, the name is only stored if it is not empty.
+      auto flags = reader.readFlags(2);
+      if (flags[0]) {
+        layer->name = reader.readUTF8String();
+      }
+    } else {
+      layer->reference = reader.readEncodedUint32();
+    }
+    return !reader.failed();
+  }
+
+  void collectLayerNames(ID id, std::unordered_set<ID>* visited, std::vector<std::string>* names) {
+    auto result = compositions.find(id);
+    if (result == compositions.end() || result->second.type != CompositionType::Vector ||
+        !visited->insert(id).second) {
+      return;
+    }
+    for (auto& layer : result->second.layers) {
+      names->push_back(layer.name);
+      if (layer.type == LayerType::PreCompose) {
+        collectLayerNames(layer.reference, visited, names);
+      }
+    }
+  }
+};
+
+bool ProbeFile(const std::string& path, FileProbe* probe) {
+  if (path.empty() || probe == nullptr) {
+    return false;
+  }
+  auto source = FileProbeSource::Open(path);
+  if (source == nullptr) {
+    return false;
+  }
+  return TagWalker(source.get()).walkFile(probe);
+}
+
+bool ProbeFile(const uint8_t* data, size_t length, FileProbe* probe) {
+  if (data == nullptr || probe == nullptr) {
+    return false;
+  }
+  DataProbeSource source(data, length);
+  return TagWalker(&source).walkFile(probe);
+}
+}  // namespace pag
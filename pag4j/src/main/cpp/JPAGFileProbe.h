@@ -0,0 +1,60 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pag {
+/**
+ * The metadata of a pag file read by ProbeFile().
+ */
+struct FileProbe {
+  int32_t width = 0;
+  int32_t height = 0;
+  // The duration of the root composition in frames.
+  int64_t duration = 0;
+  float frameRate = 0;
+  // The highest tag code found in the tags of the file, its compositions and their layers. The
+  // tags nested deeper, such as the ones of shapes and texts, are skipped and not counted.
+  uint16_t tagLevel = 0;
+  int numTexts = 0;
+  int numImages = 0;
+  int numVideos = 0;
+  // The names of all layers in depth-first order from the root composition. A composition
+  // referenced by several layers is only visited once.
+  std::vector<std::string> layerNames = {};
+};
+
+/**
+ * Reads the metadata of the pag file at the path without decoding it. Only the file header, the
+ * tag headers of the file, its compositions and their layers, and the few tags holding the
+ * composition attributes, the layer names and the layer references are read. All other tags, the
+ * image bytes and the bitmap and video sequences included, are skipped by their length. Returns
+ * false if the file is not a pag file or a tag runs past the end of the file.
+ */
+bool ProbeFile(const std::string& path, FileProbe* probe);
+
+/**
+ * Reads the metadata of the pag file data, see ProbeFile(const std::string&, FileProbe*).
+ */
+bool ProbeFile(const uint8_t* data, size_t length, FileProbe* probe);
+}  // namespace pag
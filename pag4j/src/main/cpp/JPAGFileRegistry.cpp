@@ -0,0 +1,263 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JPAGFileRegistry.h"
+#include <algorithm>
+#include <cstdio>
+#include "JFrameFingerprint.h"
+#include "JTrace.h"
+
+using namespace pag;
+
+static constexpr uint64_t CheckSeed = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t HashBytes(const void* bytes, size_t length, uint64_t seed) {
+  XXH64Hasher hasher(seed);
+  hasher.update(bytes, length);
+  return hasher.digest();
+}
+
+static bool ReadFileBytes(const std::string& path, std::vector<uint8_t>* bytes) {
+  auto file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  uint8_t buffer[64 * 1024];
+  size_t length = 0;
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes->insert(bytes->end(), buffer, buffer + length);
+  }
+  auto failed = ferror(file) != 0;
+  fclose(file);
+  return !failed;
+}
+
+struct ImageCandidate {
+  int editableIndex = 0;
+  uint64_t hash = 0;
+  uint64_t check = 0;
+  size_t length = 0;
+  std::shared_ptr<PAGImage> image = nullptr;
+};
+
+// Makes a PAGImage from the image bytes of every editable image of the file. Only the header of
+// the bytes is parsed here, the pixels are decoded by the renderer.
+static std::vector<ImageCandidate> CollectImages(std::shared_ptr<PAGFile> file) {
+  PAG4J_TRACE_EVENT("jni", "PAGFileRegistry::CollectImages");
+  std::vector<ImageCandidate> candidates = {};
+  for (auto index : file->getEditableIndices(LayerType::Image)) {
+    auto layers = file->getLayersByEditableIndex(index, LayerType::Image);
+    if (layers.empty()) {
+      continue;
+    }
+    auto imageLayer = std::static_pointer_cast<PAGImageLayer>(layers.front());
+    auto bytes = imageLayer->imageBytes();
+    if (bytes == nullptr || bytes->length() == 0) {
+      continue;
+    }
+    auto image = PAGImage::FromBytes(bytes->data(), bytes->length());
+    auto bounds = imageLayer->getBounds();
+    // A replacement image is fitted to the layer bounds, which only draws it unchanged if it
+    // covers them at full size.
+    if (image == nullptr || static_cast<float>(image->width()) != bounds.width() ||
+        static_cast<float>(image->height()) != bounds.height()) {
+      continue;
+    }
+    candidates.push_back({index, HashBytes(bytes->data(), bytes->length(), 0),
+                          HashBytes(bytes->data(), bytes->length(), CheckSeed), bytes->length(),
+                          image});
+  }
+  return candidates;
+}
+
+JPAGFileRegistry* JPAGFileRegistry::GetInstance() {
+  // Never destroyed, PAGFiles may still be released by the finalizers while the process exits.
+  static auto registry = new JPAGFileRegistry();
+  return registry;
+}
+
+std::shared_ptr<PAGFile> JPAGFileRegistry::load(const std::string& path) {
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    if (!enabled) {
+      return PAGFile::Load(path);
+    }
+  }
+  std::vector<uint8_t> bytes = {};
+  if (!ReadFileBytes(path, &bytes)) {
+    return nullptr;
+  }
+  return load(bytes.data(), bytes.size(), path);
+}
+
+std::shared_ptr<PAGFile> JPAGFileRegistry::load(const void* bytes, size_t length,
+                                                const std::string& path) {
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    if (!enabled) {
+      return PAGFile::Load(bytes, length, path);
+    }
+  }
+  uint64_t hash = 0;
+  uint64_t check = 0;
+  {
+    PAG4J_TRACE_EVENT("jni", "PAGFileRegistry::hash");
+    hash = HashBytes(bytes, length, 0);
+    check = HashBytes(bytes, length, CheckSeed);
+  }
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    purge();
+    auto entry = findEntry(hash, check, length);
+    if (entry != nullptr) {
+      sharedLoads++;
+      sharedBytes += static_cast<int64_t>(length);
+      return makeCopy(entry);
+    }
+  }
+  // Parses without holding the lock, so that the loader threads still run in parallel. If another
+  // thread registered the same contents in the meantime, its prototype wins.
+  auto prototype = PAGFile::Load(bytes, length, path);
+  if (prototype == nullptr) {
+    return nullptr;
+  }
+  auto candidates = CollectImages(prototype);
+  std::lock_guard<std::mutex> autoLock(locker);
+  auto entry = findEntry(hash, check, length);
+  if (entry == nullptr) {
+    auto& bucket = entries[hash];
+    bucket.push_back({check, length, prototype, {}, {}});
+    entry = &bucket.back();
+    for (auto& candidate : candidates) {
+      auto image = findImage(candidate.hash, candidate.check, candidate.length);
+      if (image != nullptr) {
+        sharedImages++;
+      } else {
+        image = candidate.image;
+        images[candidate.hash].push_back({candidate.check, candidate.length, image});
+      }
+      entry->images.push_back({candidate.editableIndex, image});
+    }
+  }
+  return makeCopy(entry);
+}
+
+void JPAGFileRegistry::setEnabled(bool value) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  enabled = value;
+}
+
+void JPAGFileRegistry::getStats(int64_t* values, int count) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  purge();
+  int64_t numContents = 0;
+  int64_t numInstances = 0;
+  for (auto& item : entries) {
+    for (auto& entry : item.second) {
+      numContents++;
+      numInstances += static_cast<int64_t>(entry.instances.size());
+    }
+  }
+  int64_t numImages = 0;
+  for (auto& item : images) {
+    numImages += static_cast<int64_t>(item.second.size());
+  }
+  int64_t stats[] = {numContents, numInstances, sharedLoads, sharedBytes, numImages, sharedImages};
+  std::copy(stats, stats + std::min(count, 6), values);
+}
+
+JPAGFileRegistry::Entry* JPAGFileRegistry::findEntry(uint64_t hash, uint64_t check,
+                                                     size_t length) {
+  auto result = entries.find(hash);
+  if (result == entries.end()) {
+    return nullptr;
+  }
+  for (auto& entry : result->second) {
+    if (entry.check == check && entry.length == length) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<PAGImage> JPAGFileRegistry::findImage(uint64_t hash, uint64_t check,
+                                                      size_t length) {
+  auto result = images.find(hash);
+  if (result == images.end()) {
+    return nullptr;
+  }
+  for (auto& item : result->second) {
+    // An expired image may still be listed next to the one registered after it.
+    auto image = item.image.lock();
+    if (image != nullptr && item.check == check && item.length == length) {
+      return image;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<PAGFile> JPAGFileRegistry::makeCopy(Entry* entry) {
+  std::shared_ptr<PAGFile> file = nullptr;
+  {
+    PAG4J_TRACE_EVENT("pag", "PAGFile::copyOriginal");
+    file = entry->prototype->copyOriginal();
+  }
+  if (file == nullptr) {
+    return nullptr;
+  }
+  for (auto& image : entry->images) {
+    file->replaceImage(image.editableIndex, image.image);
+  }
+  entry->instances.push_back(file);
+  return file;
+}
+
+void JPAGFileRegistry::purge() {
+  for (auto item = entries.begin(); item != entries.end();) {
+    auto& bucket = item->second;
+    for (auto& entry : bucket) {
+      auto& instances = entry.instances;
+      instances.erase(std::remove_if(instances.begin(), instances.end(),
+                                     [](const std::weak_ptr<PAGFile>& instance) {
+                                       return instance.expired();
+                                     }),
+                      instances.end());
+    }
+    bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                [](const Entry& entry) { return entry.instances.empty(); }),
+                 bucket.end());
+    if (bucket.empty()) {
+      item = entries.erase(item);
+    } else {
+      ++item;
+    }
+  }
+  // The images of the entries just erased are released with them.
+  for (auto item = images.begin(); item != images.end();) {
+    auto& bucket = item->second;
+    bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                [](const ImageEntry& image) { return image.image.expired(); }),
+                 bucket.end());
+    if (bucket.empty()) {
+      item = images.erase(item);
+    } else {
+      ++item;
+    }
+  }
+}
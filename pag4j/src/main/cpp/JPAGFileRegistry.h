@@ -0,0 +1,111 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pag/pag.h"
+
+/**
+ * Shares the parsed data of pag files with identical contents across every file loaded in the
+ * process. The first load of some contents is kept as a prototype, and every load, including the
+ * first one, returns a copyOriginal() of it. The copies reference the same pag::File, so the
+ * renderer caches its images, sequences and glyphs once per player instead of once per file. A
+ * prototype is released when the last PAGFile copied from it is destroyed. Sharing is disabled by
+ * default, a disabled registry loads through PAGFile::Load() without reading or hashing the bytes.
+ * Files with different contents still share their embedded images: the image bytes of each
+ * editable image are hashed, and every file embedding the same bytes has them replaced with one
+ * PAGImage, so the renderer decodes and uploads them once. Images stored at a scale factor or
+ * trimmed to their opaque area are not shared, a replacement would be fitted to the layer bounds.
+ */
+class JPAGFileRegistry {
+ public:
+  /**
+   * Returns the process-wide registry.
+   */
+  static JPAGFileRegistry* GetInstance();
+
+  /**
+   * Loads the pag file at the path, returns nullptr if it does not exist or is not a pag file.
+   */
+  std::shared_ptr<pag::PAGFile> load(const std::string& path);
+
+  /**
+   * Parses the bytes of a pag file, returns nullptr if they are not a pag file.
+   */
+  std::shared_ptr<pag::PAGFile> load(const void* bytes, size_t length, const std::string& path);
+
+  /**
+   * Sets whether loads are shared. When disabled, every load parses the file again, the files
+   * already shared stay shared until they are released. A shared file keeps the path of the first
+   * load of its contents.
+   */
+  void setEnabled(bool value);
+
+  /**
+   * Writes up to 6 values: the number of distinct contents alive, the number of PAGFiles alive
+   * that are copied from them, the number of loads served by an existing prototype, the file
+   * bytes those loads did not parse again, the number of distinct images alive and the number of
+   * images that reused the image of another file.
+   */
+  void getStats(int64_t* values, int count);
+
+ private:
+  struct SharedImage {
+    int editableIndex = 0;
+    std::shared_ptr<pag::PAGImage> image = nullptr;
+  };
+
+  struct Entry {
+    uint64_t check = 0;
+    size_t length = 0;
+    std::shared_ptr<pag::PAGFile> prototype = nullptr;
+    std::vector<std::weak_ptr<pag::PAGFile>> instances = {};
+    // Replaces the images of every copy of the prototype.
+    std::vector<SharedImage> images = {};
+  };
+
+  struct ImageEntry {
+    uint64_t check = 0;
+    size_t length = 0;
+    std::weak_ptr<pag::PAGImage> image = {};
+  };
+
+  std::mutex locker = {};
+  bool enabled = false;
+  // Keyed by the XXH64 of the contents, the entries also compare a second hash with another seed
+  // and the length, so files are never mixed up without keeping their bytes.
+  std::unordered_map<uint64_t, std::vector<Entry>> entries = {};
+  // Keyed like the entries, by the hashes of the image bytes. An image lives as long as a file
+  // uses it.
+  std::unordered_map<uint64_t, std::vector<ImageEntry>> images = {};
+  int64_t sharedLoads = 0;
+  int64_t sharedBytes = 0;
+  int64_t sharedImages = 0;
+
+  JPAGFileRegistry() = default;
+
+  Entry* findEntry(uint64_t hash, uint64_t check, size_t length);
+  std::shared_ptr<pag::PAGImage> findImage(uint64_t hash, uint64_t check, size_t length);
+  std::shared_ptr<pag::PAGFile> makeCopy(Entry* entry);
+  void purge();
+};
@@ -0,0 +1,440 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JPAGFrameExporter.h"
+#include <chrono>
+#include <cstdio>
+#include "JFrameEncoder.h"
+#include "JNIHelper.h"
+#include "JPAGPlayer.h"
+#include "JTrace.h"
+
+using namespace pag;
+
+std::unique_ptr<JPAGFrameExporter> JPAGFrameExporter::Make(int format, int threadCount,
+                                                           int queueCapacity) {
+  if ((format != FormatPNG && format != FormatY4M) || threadCount <= 0 || queueCapacity <= 0) {
+    return nullptr;
+  }
+  std::unique_ptr<JPAGFrameExporter> exporter(new JPAGFrameExporter(format));
+  // Every worker needs at least one queued frame to stay busy while the next one is rendered.
+  exporter->jobs.resize(static_cast<size_t>(std::max(queueCapacity, threadCount + 1)));
+  for (int i = 0; i < threadCount; i++) {
+    exporter->workers.emplace_back(&JPAGFrameExporter::encodeLoop, exporter.get());
+  }
+  return exporter;
+}
+
+JPAGFrameExporter::~JPAGFrameExporter() {
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    exiting = true;
+  }
+  condition.notify_all();
+  for (auto& worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+bool JPAGFrameExporter::exportFrames(std::shared_ptr<PAGPlayer> player, int64_t startFrame,
+                                     int64_t endFrame, FrameWriter* writer,
+                                     std::shared_ptr<JStaticFrames> staticFrames) {
+  if (player == nullptr || writer == nullptr) {
+    return false;
+  }
+  auto surface = player->getSurface();
+  auto composition = player->getComposition();
+  if (surface == nullptr || composition == nullptr) {
+    LOGE("JPAGFrameExporter::exportFrames(): The player has no surface or composition!");
+    return false;
+  }
+  std::lock_guard<std::mutex> exportLock(exportLocker);
+  auto totalFrames = CountFrames(composition);
+  startFrame = std::max<int64_t>(startFrame, 0);
+  endFrame = std::min(endFrame, totalFrames);
+  width = surface->width();
+  height = surface->height();
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  {
+    std::lock_guard<std::mutex> autoLock(locker);
+    exportedFrames = 0;
+    exportedFPS = 0;
+    writeIndex = 0;
+    inFlight = 0;
+    lastWritten.clear();
+  }
+  if (staticFrames != nullptr && !staticFrames->matches(composition)) {
+    staticFrames = nullptr;
+  }
+  auto startTime = std::chrono::steady_clock::now();
+  bool success = true;
+  if (_format == FormatY4M) {
+    auto header = MakeY4MHeader(width, height, composition->frameRate());
+    success = writer->writeHeader(reinterpret_cast<const uint8_t*>(header.data()), header.size());
+  }
+  // PNG keeps the alpha channel, while Y4M has none and needs the frame composited over black.
+  auto alphaType = _format == FormatPNG ? AlphaType::Unpremultiplied : AlphaType::Premultiplied;
+  for (auto frame = startFrame; success && frame < endFrame; frame++) {
+    // Waits for the slot of this frame, which is freed once the frame queueCapacity before it has
+    // been written.
+    if (!writeEncodedJobs(writer, jobs.size() - 1)) {
+      success = false;
+      break;
+    }
+    auto& job = jobs[static_cast<size_t>(frame - startFrame) % jobs.size()];
+    job.frame = frame;
+    job.failed = false;
+    job.duplicate = frame > startFrame && staticFrames != nullptr &&
+                    staticFrames->isDuplicate(frame);
+    if (job.duplicate) {
+      std::lock_guard<std::mutex> autoLock(locker);
+      job.state = JobState::Encoded;
+      inFlight++;
+      continue;
+    }
+    job.pixels.resize(rowBytes * height);
+    player->setProgress(FrameToProgress(frame, totalFrames));
+    {
+      PAG4J_TRACE_EVENT("pag", "PAGPlayer::flush");
+      player->flush();
+    }
+    PAG4J_TRACE_EVENT("pag", "PAGSurface::readPixels");
+    if (!surface->readPixels(ColorType::RGBA_8888, alphaType, job.pixels.data(), rowBytes)) {
+      LOGE("JPAGFrameExporter::exportFrames(): Failed to read the pixels of a frame!");
+      success = false;
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> autoLock(locker);
+      job.state = JobState::Queued;
+      encodeQueue.push_back(&job);
+      inFlight++;
+    }
+    condition.notify_all();
+  }
+  if (success) {
+    success = writeEncodedJobs(writer, 0);
+  }
+  if (!success) {
+    waitForWorkers();
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime);
+  std::lock_guard<std::mutex> autoLock(locker);
+  exportedFrames = static_cast<int64_t>(writeIndex);
+  exportedFPS = seconds.count() > 0 ? static_cast<double>(writeIndex) / seconds.count() : 0;
+  return success;
+}
+
+bool JPAGFrameExporter::writeEncodedJobs(FrameWriter* writer, size_t maxInFlight) {
+  while (true) {
+    Job* job = nullptr;
+    {
+      std::unique_lock<std::mutex> autoLock(locker);
+      if (inFlight <= maxInFlight) {
+        return true;
+      }
+      job = &jobs[writeIndex % jobs.size()];
+      condition.wait(autoLock, [job] { return job->state == JobState::Encoded; });
+    }
+    // Writing happens outside the lock, so the workers keep encoding meanwhile.
+    PAG4J_TRACE_EVENT("pag", "PAGFrameExporter::write");
+    auto& data = job->duplicate ? lastWritten : job->data;
+    auto success = !job->failed && writer->writeFrame(job->frame, data.data(), data.size());
+    if (success && !job->duplicate) {
+      // The encoder clears the buffer before reusing it, keeping the written data avoids a copy.
+      lastWritten.swap(job->data);
+    }
+    {
+      std::lock_guard<std::mutex> autoLock(locker);
+      job->state = JobState::Free;
+      if (success) {
+        writeIndex++;
+      }
+      inFlight--;
+    }
+    if (!success) {
+      return false;
+    }
+  }
+}
+
+void JPAGFrameExporter::waitForWorkers() {
+  std::unique_lock<std::mutex> autoLock(locker);
+  condition.wait(autoLock, [this] {
+    for (auto& job : jobs) {
+      if (job.state == JobState::Queued || job.state == JobState::Encoding) {
+        return false;
+      }
+    }
+    return true;
+  });
+  for (auto& job : jobs) {
+    job.state = JobState::Free;
+  }
+  inFlight = 0;
+}
+
+void JPAGFrameExporter::encodeLoop() {
+  JTrace::SetThreadName("PAGFrameExporter");
+  while (true) {
+    Job* job = nullptr;
+    {
+      std::unique_lock<std::mutex> autoLock(locker);
+      condition.wait(autoLock, [this] { return exiting || !encodeQueue.empty(); });
+      if (exiting) {
+        return;
+      }
+      job = encodeQueue.front();
+      encodeQueue.pop_front();
+      job->state = JobState::Encoding;
+    }
+    PAG4J_TRACE_EVENT("pag", "PAGFrameExporter::encode");
+    job->data.clear();
+    if (_format == FormatPNG) {
+      job->failed = !EncodePNG(job->pixels.data(), width, height, &job->data);
+    } else {
+      EncodeY4MFrame(job->pixels.data(), width, height, &job->data);
+    }
+    {
+      std::lock_guard<std::mutex> autoLock(locker);
+      job->state = JobState::Encoded;
+    }
+    condition.notify_all();
+  }
+}
+
+namespace {
+class DirectoryWriter : public FrameWriter {
+ public:
+  DirectoryWriter(std::string directory, int format)
+      : directory(std::move(directory)), format(format) {
+  }
+
+  ~DirectoryWriter() override {
+    if (stream != nullptr) {
+      fclose(stream);
+    }
+  }
+
+  bool writeHeader(const uint8_t* data, size_t size) override {
+    stream = fopen((directory + "/frames.y4m").c_str(), "wb");
+    return stream != nullptr && fwrite(data, 1, size, stream) == size;
+  }
+
+  bool writeFrame(int64_t frame, const uint8_t* data, size_t size) override {
+    if (format == JPAGFrameExporter::FormatY4M) {
+      return stream != nullptr && fwrite(data, 1, size, stream) == size;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "/%06lld.png", static_cast<long long>(frame));
+    auto file = fopen((directory + name).c_str(), "wb");
+    if (file == nullptr) {
+      LOGE("PAGFrameExporter: Failed to create the file of frame %lld!",
+           static_cast<long long>(frame));
+      return false;
+    }
+    auto success = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && success;
+  }
+
+ private:
+  std::string directory;
+  int format = JPAGFrameExporter::FormatPNG;
+  FILE* stream = nullptr;
+};
+
+class OutputStreamWriter : public FrameWriter {
+ public:
+  OutputStreamWriter(JNIEnv* env, jobject stream) : env(env), stream(stream) {
+    auto streamClass = env->GetObjectClass(stream);
+    writeMethod = env->GetMethodID(streamClass, "write", "([BII)V");
+    env->DeleteLocalRef(streamClass);
+  }
+
+  ~OutputStreamWriter() override {
+    if (buffer != nullptr) {
+      env->DeleteLocalRef(buffer);
+    }
+  }
+
+  bool writeHeader(const uint8_t* data, size_t size) override {
+    return write(data, size);
+  }
+
+  bool writeFrame(int64_t, const uint8_t* data, size_t size) override {
+    return write(data, size);
+  }
+
+ private:
+  JNIEnv* env = nullptr;
+  jobject stream = nullptr;
+  jmethodID writeMethod = nullptr;
+  jbyteArray buffer = nullptr;
+  size_t bufferSize = 0;
+
+  bool write(const uint8_t* data, size_t size) {
+    if (writeMethod == nullptr) {
+      return false;
+    }
+    if (buffer == nullptr || bufferSize < size) {
+      if (buffer != nullptr) {
+        env->DeleteLocalRef(buffer);
+      }
+      buffer = env->NewByteArray(static_cast<jsize>(size));
+      bufferSize = buffer != nullptr ? size : 0;
+      if (buffer == nullptr) {
+        env->ExceptionClear();
+        return false;
+      }
+    }
+    env->SetByteArrayRegion(buffer, 0, static_cast<jsize>(size),
+                            reinterpret_cast<const jbyte*>(data));
+    env->CallVoidMethod(stream, writeMethod, buffer, 0, static_cast<jint>(size));
+    if (env->ExceptionCheck()) {
+      env->ExceptionClear();
+      LOGE("PAGFrameExporter: The OutputStream failed to write a frame!");
+      return false;
+    }
+    return true;
+  }
+};
+}  // namespace
+
+namespace pag {
+static jfieldID PAGFrameExporter_nativeContext;
+}
+
+static JPAGFrameExporter* GetFrameExporter(JNIEnv* env, jobject thiz) {
+  return reinterpret_cast<JPAGFrameExporter*>(
+      env->GetLongField(thiz, PAGFrameExporter_nativeContext));
+}
+
+static std::shared_ptr<PAGPlayer> ToPAGPlayer(JPAGPlayer* jPlayer) {
+  if (jPlayer == nullptr) {
+    return nullptr;
+  }
+  return jPlayer->get();
+}
+
+static std::shared_ptr<JStaticFrames> ToStaticFrames(JPAGPlayer* jPlayer) {
+  if (jPlayer == nullptr) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  return jPlayer->staticFrames;
+}
+
+static jboolean FinishExport(JPAGPlayer* jPlayer, bool success) {
+  if (jPlayer != nullptr) {
+    // The surface now shows the last exported frame instead of the last frame flushed by the user.
+    std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+    jPlayer->lastFlushedFrame = -1;
+  }
+  return static_cast<jboolean>(success);
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGFrameExporter_SetupExporter(JNIEnv*, jclass,
+                                                                       jint format,
+                                                                       jint threadCount,
+                                                                       jint queueCapacity) {
+  auto exporter = JPAGFrameExporter::Make(format, threadCount, queueCapacity);
+  if (exporter == nullptr) {
+    LOGE("PAGFrameExporter.SetupExporter(): Invalid format or thread count!");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(exporter.release());
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGFrameExporter_nativeRelease(JNIEnv* env, jobject thiz) {
+  delete GetFrameExporter(env, thiz);
+  env->SetLongField(thiz, PAGFrameExporter_nativeContext, 0);
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGFrameExporter_nativeExportToDirectory(
+    JNIEnv* env, jobject thiz, jobject playerObject, jlong startFrame, jlong endFrame,
+    jstring directory) {
+  PAG4J_TRACE_EVENT("jni", "PAGFrameExporter.nativeExportToDirectory");
+  auto exporter = GetFrameExporter(env, thiz);
+  auto path = SafeConvertToStdString(env, directory);
+  if (exporter == nullptr || playerObject == nullptr || path.empty()) {
+    return JNI_FALSE;
+  }
+  // The player object is an argument of this call, so it stays reachable for the whole export.
+  auto jPlayer = getJPAGPlayer(env, playerObject);
+  DirectoryWriter writer(path, exporter->format());
+  auto success = exporter->exportFrames(ToPAGPlayer(jPlayer), startFrame, endFrame, &writer,
+                                        ToStaticFrames(jPlayer));
+  return FinishExport(jPlayer, success);
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGFrameExporter_nativeExportToStream(
+    JNIEnv* env, jobject thiz, jobject playerObject, jlong startFrame, jlong endFrame,
+    jobject stream) {
+  PAG4J_TRACE_EVENT("jni", "PAGFrameExporter.nativeExportToStream");
+  auto exporter = GetFrameExporter(env, thiz);
+  if (exporter == nullptr || playerObject == nullptr || stream == nullptr) {
+    return JNI_FALSE;
+  }
+  auto jPlayer = getJPAGPlayer(env, playerObject);
+  OutputStreamWriter writer(env, stream);
+  auto success = exporter->exportFrames(ToPAGPlayer(jPlayer), startFrame, endFrame, &writer,
+                                        ToStaticFrames(jPlayer));
+  return FinishExport(jPlayer, success);
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGFrameExporter_frameCount(JNIEnv* env, jobject thiz) {
+  auto exporter = GetFrameExporter(env, thiz);
+  return exporter != nullptr ? exporter->frameCount() : 0;
+}
+
+JNIEXPORT jdouble JNICALL Java_org_libpag_PAGFrameExporter_framesPerSecond(JNIEnv* env,
+                                                                           jobject thiz) {
+  auto exporter = GetFrameExporter(env, thiz);
+  return exporter != nullptr ? exporter->framesPerSecond() : 0;
+}
+}
+
+static JNINativeMethod PAGFrameExporter_methods[] = {
+    {"SetupExporter", "(III)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFrameExporter_SetupExporter)},
+    {"nativeExportToDirectory", "(Lorg/libpag/PAGPlayer;JJLjava/lang/String;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFrameExporter_nativeExportToDirectory)},
+    {"nativeExportToStream", "(Lorg/libpag/PAGPlayer;JJLjava/io/OutputStream;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFrameExporter_nativeExportToStream)},
+    {"frameCount", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGFrameExporter_frameCount)},
+    {"framesPerSecond", "()D",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFrameExporter_framesPerSecond)},
+    {"nativeRelease", "()V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGFrameExporter_nativeRelease)},
+};
+
+namespace pag {
+bool RegisterPAGFrameExporterNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGFrameExporter", PAGFrameExporter_methods,
+                                     sizeof(PAGFrameExporter_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGFrameExporter_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
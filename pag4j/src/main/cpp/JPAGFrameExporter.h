@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include "JStaticFrames.h"
+#include "pag/pag.h"
+
+/**
+ * Receives the encoded frames of an export in frame order, on the thread that runs the export.
+ */
+class FrameWriter {
+ public:
+  virtual ~FrameWriter() = default;
+
+  /**
+   * Writes the header of the output, which is only called once before the first frame.
+   */
+  virtual bool writeHeader(const uint8_t* data, size_t size) = 0;
+
+  virtual bool writeFrame(int64_t frame, const uint8_t* data, size_t size) = 0;
+};
+
+/**
+ * Exports a frame range of a PAGPlayer as a PNG sequence or a YUV4MPEG2 stream. Frames are
+ * rendered and read back on the calling thread and encoded in parallel by a pool of worker
+ * threads. At most queueCapacity frames are in flight at once, so rendering waits when the
+ * encoders or the writer fall behind.
+ */
+class JPAGFrameExporter {
+ public:
+  static constexpr int FormatPNG = 0;
+  static constexpr int FormatY4M = 1;
+
+  static std::unique_ptr<JPAGFrameExporter> Make(int format, int threadCount, int queueCapacity);
+
+  ~JPAGFrameExporter();
+
+  int format() const {
+    return _format;
+  }
+
+  /**
+   * Renders the frames in [startFrame, endFrame) of the player's composition into its surface and
+   * passes them to the writer once encoded. The range is clamped to the frames of the composition.
+   * Returns false if the player has no surface or composition, or if any frame failed to render,
+   * encode or write. If staticFrames matches the composition, duplicate frames are neither
+   * rendered nor encoded, the writer receives the data of the previous frame again.
+   */
+  bool exportFrames(std::shared_ptr<pag::PAGPlayer> player, int64_t startFrame, int64_t endFrame,
+                    FrameWriter* writer,
+                    std::shared_ptr<pag::JStaticFrames> staticFrames = nullptr);
+
+  /**
+   * Returns the number of frames written by the last export.
+   */
+  int64_t frameCount() {
+    std::lock_guard<std::mutex> autoLock(locker);
+    return exportedFrames;
+  }
+
+  /**
+   * Returns the throughput of the last export, from the first render to the last write.
+   */
+  double framesPerSecond() {
+    std::lock_guard<std::mutex> autoLock(locker);
+    return exportedFPS;
+  }
+
+ private:
+  enum class JobState { Free, Queued, Encoding, Encoded };
+
+  struct Job {
+    int64_t frame = 0;
+    std::vector<uint8_t> pixels = {};
+    std::vector<uint8_t> data = {};
+    bool failed = false;
+    // Set for frames that repeat the previous frame, they are written without being encoded.
+    bool duplicate = false;
+    JobState state = JobState::Free;
+  };
+
+  int _format = FormatPNG;
+  int width = 0;
+  int height = 0;
+  std::vector<Job> jobs = {};
+  std::deque<Job*> encodeQueue = {};
+  size_t writeIndex = 0;
+  std::vector<uint8_t> lastWritten = {};
+  size_t inFlight = 0;
+  int64_t exportedFrames = 0;
+  double exportedFPS = 0;
+  bool exiting = false;
+  std::mutex exportLocker = {};
+  std::mutex locker = {};
+  std::condition_variable condition = {};
+  std::vector<std::thread> workers = {};
+
+  explicit JPAGFrameExporter(int format) : _format(format) {
+  }
+
+  bool writeEncodedJobs(FrameWriter* writer, size_t maxInFlight);
+  void waitForWorkers();
+  void encodeLoop();
+};
@@ -18,6 +18,7 @@
 
 #include "JNIHelper.h"
 #include "JPAGLayerHandle.h"
+#include "JTrace.h"
 
 static jfieldID PAGLayer_nativeContext;
 
@@ -39,10 +40,6 @@ std::shared_ptr<PAGLayer> GetPAGLayer(JNIEnv* env, jobject thiz) {
 
 extern "C" {
 
-JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_nativeInit(JNIEnv* env, jclass clazz) {
-  PAGLayer_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
-}
-
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_nativeRelease(JNIEnv* env, jobject thiz) {
   SetPAGLayer(env, thiz, nullptr);
 }
@@ -83,6 +80,7 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_matrix(JNIEnv* env, jobject thiz
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_setMatrix(JNIEnv* env, jobject thiz,
                                                           jfloatArray matrixObject) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.setMatrix");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return;
@@ -97,20 +95,24 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_setMatrix(JNIEnv* env, jobject t
   auto matrixArray = env->GetFloatArrayElements(matrixObject, nullptr);
   matrix.set9(matrixArray);
   pagLayer->setMatrix(matrix);
+  MarkContentChanged(pagLayer);
   env->ReleaseFloatArrayElements(matrixObject, matrixArray, 0);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_resetMatrix(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.resetMatrix");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return;
   }
 
   pagLayer->resetMatrix();
+  MarkContentChanged(pagLayer);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_getTotalMatrix(JNIEnv* env, jobject thiz,
                                                                jfloatArray matrixObject) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.getTotalMatrix");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return;
@@ -132,12 +134,14 @@ JNIEXPORT jboolean JNICALL Java_org_libpag_PAGLayer_visible(JNIEnv* env, jobject
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_setVisible(JNIEnv* env, jobject thiz, jboolean visible) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.setVisible");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return;
   }
 
   pagLayer->setVisible(visible);
+  MarkContentChanged(pagLayer);
 }
 
 JNIEXPORT jint JNICALL Java_org_libpag_PAGLayer_editableIndex(JNIEnv* env, jobject thiz) {
@@ -204,11 +208,13 @@ JNIEXPORT jlong JNICALL Java_org_libpag_PAGLayer_startTime(JNIEnv* env, jobject
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_setStartTime(JNIEnv* env, jobject thiz, jlong time) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.setStartTime");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return;
   }
   pagLayer->setStartTime(time);
+  MarkContentChanged(pagLayer);
 }
 
 JNIEXPORT jlong JNICALL Java_org_libpag_PAGLayer_currentTime(JNIEnv* env, jobject thiz) {
@@ -220,11 +226,13 @@ JNIEXPORT jlong JNICALL Java_org_libpag_PAGLayer_currentTime(JNIEnv* env, jobjec
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_setCurrentTime(JNIEnv* env, jobject thiz, jlong time) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.setCurrentTime");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return;
   }
   pagLayer->setCurrentTime(time);
+  MarkContentChanged(pagLayer);
 }
 
 JNIEXPORT jdouble JNICALL Java_org_libpag_PAGLayer_getProgress(JNIEnv* env, jobject thiz) {
@@ -236,11 +244,13 @@ JNIEXPORT jdouble JNICALL Java_org_libpag_PAGLayer_getProgress(JNIEnv* env, jobj
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_setProgress(JNIEnv* env, jobject thiz, jdouble progress) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.setProgress");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return;
   }
   pagLayer->setProgress(progress);
+  MarkContentChanged(pagLayer);
 }
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGLayer_trackMatteLayer(JNIEnv* env, jobject thiz) {
@@ -255,6 +265,7 @@ JNIEXPORT jobject JNICALL Java_org_libpag_PAGLayer_trackMatteLayer(JNIEnv* env,
 }
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGLayer_getBounds(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGLayer.getBounds");
   auto pagLayer = GetPAGLayer(env, thiz);
   if (pagLayer == nullptr) {
     return MakeRectFObject(env, 0.0f, 0.0f, 0.0f, 0.0f);
@@ -281,5 +292,56 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGLayer_setExcludedFromTimeline(JNIEnv*
   }
 
   pagLayer->setExcludedFromTimeline(value);
+  MarkContentChanged(pagLayer);
+}
 }
+
+static JNINativeMethod PAGLayer_methods[] = {
+    {"layerType", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_layerType)},
+    {"layerName", "()Ljava/lang/String;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_layerName)},
+    {"matrix", "([F)V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_matrix)},
+    {"setMatrix", "([F)V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_setMatrix)},
+    {"resetMatrix", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_resetMatrix)},
+    {"getTotalMatrix", "([F)V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_getTotalMatrix)},
+    {"visible", "()Z", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_visible)},
+    {"setVisible", "(Z)V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_setVisible)},
+    {"editableIndex", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_editableIndex)},
+    {"parent", "()Lorg/libpag/PAGComposition;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_parent)},
+    {"localTimeToGlobal", "(J)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_localTimeToGlobal)},
+    {"globalToLocalTime", "(J)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_globalToLocalTime)},
+    {"duration", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_duration)},
+    {"frameRate", "()F", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_frameRate)},
+    {"startTime", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_startTime)},
+    {"setStartTime", "(J)V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_setStartTime)},
+    {"currentTime", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_currentTime)},
+    {"setCurrentTime", "(J)V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_setCurrentTime)},
+    {"getProgress", "()D", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_getProgress)},
+    {"setProgress", "(D)V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_setProgress)},
+    {"trackMatteLayer", "()Lorg/libpag/PAGLayer;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_trackMatteLayer)},
+    {"getBounds", "()Lorg/libpag/PAGRect;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_getBounds)},
+    {"excludedFromTimeline", "()Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_excludedFromTimeline)},
+    {"setExcludedFromTimeline", "(Z)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_setExcludedFromTimeline)},
+    {"nativeRelease", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGLayer_nativeRelease)},
+    {"nativeEquals", "(Lorg/libpag/PAGLayer;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGLayer_nativeEquals)},
+};
+
+namespace pag {
+bool RegisterPAGLayerNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGLayer", PAGLayer_methods,
+                                     sizeof(PAGLayer_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGLayer_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
 }
+}  // namespace pag
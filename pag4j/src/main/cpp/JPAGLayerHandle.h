@@ -18,8 +18,16 @@
 
 #pragma once
 
+#include <mutex>
 #include "pag/pag.h"
 
+/**
+ * The native context of a Java PAGLayer. Every binding call copies the shared_ptr out of the handle
+ * under its lock and then works on the copy, so a layer may be used from several Java threads at
+ * once. The layer tree itself is guarded by libpag, which shares one lock among all layers of a
+ * tree and the player displaying it, so calls on the same tree are serialized rather than run in
+ * parallel. See PAGFileInstancePool for rendering the same file on several threads concurrently.
+ */
 class JPAGLayerHandle {
  public:
   explicit JPAGLayerHandle(std::shared_ptr<pag::PAGLayer> nativeHandle)
@@ -27,13 +35,16 @@ class JPAGLayerHandle {
   }
 
   std::shared_ptr<pag::PAGLayer> get() {
+    std::lock_guard<std::mutex> autoLock(locker);
     return nativeHandle;
   }
 
   void reset() {
+    std::lock_guard<std::mutex> autoLock(locker);
     nativeHandle = nullptr;
   }
 
  private:
   std::shared_ptr<pag::PAGLayer> nativeHandle;
+  std::mutex locker;
 };
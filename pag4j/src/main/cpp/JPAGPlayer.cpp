@@ -17,8 +17,12 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "JPAGPlayer.h"
+#include <algorithm>
+#include <cmath>
 #include "JNIHelper.h"
 #include "JPAGSurface.h"
+#include "JThumbnailRenderer.h"
+#include "JTrace.h"
 
 #ifdef PAG_USE_FFAVC
 #include "ffavc.h"
@@ -30,6 +34,21 @@ static jfieldID PAGPlayer_nativeContext;
 
 using namespace pag;
 
+// Must be kept in sync with the scrub stage constants in PAGPlayer.java.
+static constexpr jint ScrubStageNone = 0;
+static constexpr jint ScrubStagePreview = 1;
+static constexpr jint ScrubStageRefined = 2;
+
+static int64_t GetTimeMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+JPAGPlayer* getJPAGPlayer(JNIEnv* env, jobject thiz) {
+  return reinterpret_cast<JPAGPlayer*>(env->GetLongField(thiz, PAGPlayer_nativeContext));
+}
+
 std::shared_ptr<PAGPlayer> getPAGPlayer(JNIEnv* env, jobject thiz) {
   auto jPlayer = reinterpret_cast<JPAGPlayer*>(env->GetLongField(thiz, PAGPlayer_nativeContext));
   if (jPlayer == nullptr) {
@@ -38,6 +57,85 @@ std::shared_ptr<PAGPlayer> getPAGPlayer(JNIEnv* env, jobject thiz) {
   return jPlayer->get();
 }
 
+/**
+ * Makes the next flush draw even within a run of static frames, because a setting of the player
+ * has changed how the same frame looks.
+ */
+static void InvalidateLastFlush(JNIEnv* env, jobject thiz) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->lastFlushedFrame = -1;
+}
+
+/**
+ * Returns the frame the player currently displays if its static frames apply to its composition,
+ * otherwise returns -1.
+ */
+static int64_t StaticFrameOf(JPAGPlayer* jPlayer, PAGPlayer* player) {
+  auto& staticFrames = jPlayer->staticFrames;
+  if (staticFrames == nullptr || !staticFrames->matches(player->getComposition())) {
+    return -1;
+  }
+  auto numFrames = staticFrames->numFrames();
+  auto frame = static_cast<int64_t>(std::floor(player->getProgress() * numFrames));
+  return std::max<int64_t>(0, std::min(frame, numFrames - 1));
+}
+
+/**
+ * Flushes the player unless its static frames allow skipping the frame, and reports the timings of
+ * the frame to the quality governor.
+ */
+static bool FlushPlayerContent(JPAGPlayer* jPlayer, PAGPlayer* player,
+                               BackendSemaphore* semaphore) {
+  auto frame = StaticFrameOf(jPlayer, player);
+  auto version = ContentVersion(player->getComposition());
+  auto surfaceVersion = jPlayer->surface != nullptr ? jPlayer->surface->contentVersion.load() : 0;
+  if (frame >= 0 && jPlayer->lastFlushedFrame >= 0 && version == jPlayer->lastFlushedVersion &&
+      surfaceVersion == jPlayer->lastFlushedSurfaceVersion &&
+      jPlayer->staticFrames->isStaticBetween(jPlayer->lastFlushedFrame, frame)) {
+    // The surface already shows this content, skip evaluating the layer tree as well.
+    return false;
+  }
+  jPlayer->lastFlushedFrame = frame;
+  jPlayer->lastFlushedVersion = version;
+  jPlayer->lastFlushedSurfaceVersion = surfaceVersion;
+  PAG4J_TRACE_EVENT("pag", "PAGPlayer::flush");
+  auto startTime = GetTimeMicros();
+  auto changed = semaphore != nullptr ? player->flushAndSignalSemaphore(semaphore)
+                                      : player->flush();
+  if (jPlayer->governor.enabled()) {
+    auto readbackTime = jPlayer->surface != nullptr ? jPlayer->surface->readbackTime.exchange(0) : 0;
+    if (jPlayer->governor.onFrame(GetTimeMicros() - startTime, readbackTime)) {
+      jPlayer->applyQuality(player);
+    }
+  }
+  return changed;
+}
+
+/**
+ * Evicts the assets left behind, flushes the player and prerolls the upcoming ones. Must be called
+ * while holding the stateLocker of the JPAGPlayer.
+ */
+static bool FlushPlayer(JPAGPlayer* jPlayer, PAGPlayer* player,
+                        BackendSemaphore* semaphore = nullptr) {
+  // Evicting before the flush keeps the frame on the surface intact until the caller has read it
+  // back, the flush decodes the visible assets again and redraws them.
+  if (jPlayer->residency.enabled() && jPlayer->residency.beforeFlush(player)) {
+    // The prerolled assets have been freed along with the others.
+    jPlayer->preroll.reset();
+    // The surface lost its content, the frame must not be skipped as a static one.
+    jPlayer->lastFlushedFrame = -1;
+  }
+  auto changed = FlushPlayerContent(jPlayer, player, semaphore);
+  if (jPlayer->preroll.enabled()) {
+    jPlayer->preroll.onFlush(player);
+  }
+  return changed;
+}
+
 void setPAGPlayer(JNIEnv* env, jobject thiz, JPAGPlayer* player) {
   auto old = reinterpret_cast<JPAGPlayer*>(env->GetLongField(thiz, PAGPlayer_nativeContext));
   if (old != nullptr) {
@@ -48,10 +146,6 @@ void setPAGPlayer(JNIEnv* env, jobject thiz, JPAGPlayer* player) {
 
 extern "C" {
 
-JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_nativeInit(JNIEnv* env, jclass clazz) {
-  PAGPlayer_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
-}
-
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_nativeSetup(JNIEnv* env, jobject thiz) {
   auto player = std::make_shared<PAGPlayer>();
   setPAGPlayer(env, thiz, new JPAGPlayer(player));
@@ -83,16 +177,19 @@ JNIEXPORT jobject JNICALL Java_org_libpag_PAGPlayer_getComposition(JNIEnv* env,
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setComposition(JNIEnv* env, jobject thiz,
                                                                 jobject newComposition) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.setComposition");
   auto player = getPAGPlayer(env, thiz);
   if (player == nullptr) {
     return;
   }
   auto composition = ToPAGCompositionNativeObject(env, newComposition);
   player->setComposition(composition);
+  InvalidateLastFlush(env, thiz);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_nativeSetSurface(JNIEnv* env, jobject thiz,
                                                                   jlong surfaceObject) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.nativeSetSurface");
   auto player = getPAGPlayer(env, thiz);
   if (player == nullptr) {
     return;
@@ -103,6 +200,10 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_nativeSetSurface(JNIEnv* env, j
   } else {
     player->setSurface(nullptr);
   }
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->surface = surface;
+  jPlayer->lastFlushedFrame = -1;
 }
 
 JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_videoEnabled(JNIEnv* env, jobject thiz) {
@@ -119,6 +220,7 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setVideoEnabled(JNIEnv* env, jo
     return;
   }
   player->setVideoEnabled(value);
+  InvalidateLastFlush(env, thiz);
 }
 
 JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_cacheEnabled(JNIEnv* env, jobject thiz) {
@@ -135,38 +237,49 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setCacheEnabled(JNIEnv* env, jo
     return;
   }
   player->setCacheEnabled(value);
+  InvalidateLastFlush(env, thiz);
 }
 
 JNIEXPORT jfloat JNICALL Java_org_libpag_PAGPlayer_cacheScale(JNIEnv* env, jobject thiz) {
-  auto player = getPAGPlayer(env, thiz);
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
   if (player == nullptr) {
     return 0;
   }
-  return player->cacheScale();
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  return jPlayer->cacheScale;
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setCacheScale(JNIEnv* env, jobject thiz, jfloat value) {
-  auto player = getPAGPlayer(env, thiz);
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
   if (player == nullptr) {
     return;
   }
-  player->setCacheScale(value);
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->cacheScale = value;
+  jPlayer->applyQuality(player.get());
 }
 
 JNIEXPORT jfloat JNICALL Java_org_libpag_PAGPlayer_maxFrameRate(JNIEnv* env, jobject thiz) {
-  auto player = getPAGPlayer(env, thiz);
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
   if (player == nullptr) {
     return 0;
   }
-  return player->maxFrameRate();
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  return jPlayer->maxFrameRate;
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setMaxFrameRate(JNIEnv* env, jobject thiz, jfloat value) {
-  auto player = getPAGPlayer(env, thiz);
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
   if (player == nullptr) {
     return;
   }
-  player->setMaxFrameRate(value);
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->maxFrameRate = value;
+  jPlayer->applyQuality(player.get());
 }
 
 JNIEXPORT jint JNICALL Java_org_libpag_PAGPlayer_scaleMode(JNIEnv* env, jobject thiz) {
@@ -183,6 +296,7 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setScaleMode(JNIEnv* env, jobje
     return;
   }
   player->setScaleMode(value);
+  InvalidateLastFlush(env, thiz);
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_nativeGetMatrix(JNIEnv* env, jobject thiz,
@@ -211,6 +325,7 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_nativeSetMatrix(JNIEnv* env, jo
   Matrix matrix = {};
   matrix.setAll(a, c, tx, b, d, ty, 0, 0, 1);
   player->setMatrix(matrix);
+  InvalidateLastFlush(env, thiz);
 }
 
 JNIEXPORT jlong JNICALL Java_org_libpag_PAGPlayer_duration(JNIEnv* env, jobject thiz) {
@@ -230,6 +345,7 @@ JNIEXPORT jdouble JNICALL Java_org_libpag_PAGPlayer_getProgress(JNIEnv* env, job
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setProgress(JNIEnv* env, jobject thiz, jdouble value) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.setProgress");
   auto player = getPAGPlayer(env, thiz);
   if (player == nullptr) {
     return;
@@ -246,6 +362,7 @@ JNIEXPORT jlong JNICALL Java_org_libpag_PAGPlayer_currentFrame(JNIEnv* env, jobj
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_prepare(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.prepare");
   auto player = getPAGPlayer(env, thiz);
   if (player == nullptr) {
     return;
@@ -255,25 +372,29 @@ JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_prepare(JNIEnv* env, jobject th
 
 JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_flushAndFenceSync(JNIEnv* env, jobject thiz,
                                                                        jlongArray syncArray) {
-  auto player = getPAGPlayer(env, thiz);
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.flushAndFenceSync");
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
   if (player == nullptr) {
     return 0;
   }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
   if (syncArray == nullptr || env->GetArrayLength(syncArray) == 0) {
-    return static_cast<jboolean>(player->flush());
+    return static_cast<jboolean>(FlushPlayer(jPlayer, player.get()));
   }
   auto array = env->GetLongArrayElements(syncArray, nullptr);
   if (array == nullptr) {
-    return static_cast<jboolean>(player->flush());
+    return static_cast<jboolean>(FlushPlayer(jPlayer, player.get()));
   }
   BackendSemaphore semaphore;
-  auto result = player->flushAndSignalSemaphore(&semaphore);
+  auto result = FlushPlayer(jPlayer, player.get(), &semaphore);
   array[0] = semaphore.isInitialized() ? reinterpret_cast<jlong>(semaphore.glSync()) : 0;
   env->ReleaseLongArrayElements(syncArray, array, 0);
   return result;
 }
 
 JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_waitSync(JNIEnv* env, jobject thiz, jlong sync) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.waitSync");
   auto player = getPAGPlayer(env, thiz);
   if (player == nullptr || sync == 0) {
     return false;
@@ -284,6 +405,7 @@ JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_waitSync(JNIEnv* env, jobje
 }
 
 JNIEXPORT jobject JNICALL Java_org_libpag_PAGPlayer_getBounds(JNIEnv* env, jobject thiz, jobject layer) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.getBounds");
   auto player = getPAGPlayer(env, thiz);
   if (player == nullptr) {
     return MakeRectFObject(env, 0.0f, 0.0f, 0.0f, 0.0f);
@@ -295,6 +417,7 @@ JNIEXPORT jobject JNICALL Java_org_libpag_PAGPlayer_getBounds(JNIEnv* env, jobje
 
 JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_hitTestPoint(JNIEnv* env, jobject thiz, jobject layer,
                                                                   jfloat x, jfloat y, jboolean pixelHitTest) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.hitTestPoint");
   auto player = getPAGPlayer(env, thiz);
   if (player == nullptr) {
     return JNI_FALSE;
@@ -318,4 +441,272 @@ JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_useDiskCache(JNIEnv* env, j
   }
   return player->useDiskCache();
 }
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setScrubMode(JNIEnv* env, jobject thiz,
+                                                              jboolean enabled,
+                                                              jfloat previewScale,
+                                                              jlong settleMillis) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
+  if (player == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  auto& scrub = jPlayer->scrub;
+  scrub.enabled = enabled;
+  scrub.previewScale = std::min(std::max(previewScale, 0.05f), 1.0f);
+  scrub.settleTime = std::max<int64_t>(settleMillis, 0) * 1000;
+  scrub.lastProgress = -1;
+  scrub.previewShown = false;
+  jPlayer->applyQuality(player.get());
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_scrubMode(JNIEnv* env, jobject thiz) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr) {
+    return JNI_FALSE;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  return static_cast<jboolean>(jPlayer->scrub.enabled);
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGPlayer_flushScrub(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.flushScrub");
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
+  if (player == nullptr) {
+    return ScrubStageNone;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  auto& scrub = jPlayer->scrub;
+  if (!scrub.enabled) {
+    return FlushPlayer(jPlayer, player.get()) ? ScrubStageRefined : ScrubStageNone;
+  }
+  auto now = GetTimeMicros();
+  auto progress = player->getProgress();
+  if (progress != scrub.lastProgress) {
+    scrub.lastProgress = progress;
+    scrub.lastChangeTime = now;
+  }
+  if (now - scrub.lastChangeTime < scrub.settleTime) {
+    if (!scrub.previewShown) {
+      scrub.previewShown = true;
+      jPlayer->applyQuality(player.get());
+    }
+    return FlushPlayer(jPlayer, player.get()) ? ScrubStagePreview : ScrubStageNone;
+  }
+  if (scrub.previewShown) {
+    scrub.previewShown = false;
+    jPlayer->applyQuality(player.get());
+    // Only the cache scale has changed, clearing the surface makes the next flush redraw the
+    // settled frame instead of skipping it as unchanged.
+    auto surface = player->getSurface();
+    if (surface != nullptr) {
+      surface->clearAll();
+    }
+    FlushPlayer(jPlayer, player.get());
+    return ScrubStageRefined;
+  }
+  return FlushPlayer(jPlayer, player.get()) ? ScrubStageRefined : ScrubStageNone;
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGPlayer_scrubRefineDelay(JNIEnv* env, jobject thiz) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  auto& scrub = jPlayer->scrub;
+  if (!scrub.enabled || !scrub.previewShown) {
+    return -1;
+  }
+  auto remaining = scrub.lastChangeTime + scrub.settleTime - GetTimeMicros();
+  return std::max<int64_t>(remaining, 0) / 1000;
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setStaticFrames(JNIEnv* env, jobject thiz,
+                                                                 jobject staticFrames) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->staticFrames = ToStaticFramesNativeObject(env, staticFrames);
+  jPlayer->lastFlushedFrame = -1;
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setQualityGovernor(JNIEnv* env, jobject thiz,
+                                                                    jboolean enabled,
+                                                                    jfloat targetFrameRate) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
+  if (player == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->governor.setEnabled(enabled, targetFrameRate);
+  if (jPlayer->surface != nullptr) {
+    jPlayer->surface->readbackTime = 0;
+  }
+  jPlayer->applyQuality(player.get());
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGPlayer_qualityLevel(JNIEnv* env, jobject thiz) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  return jPlayer->governor.level();
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_qualityStats(JNIEnv* env, jobject thiz,
+                                                              jfloatArray values) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  auto player = jPlayer != nullptr ? jPlayer->get() : nullptr;
+  if (player == nullptr || values == nullptr || env->GetArrayLength(values) < 5) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  auto& governor = jPlayer->governor;
+  jfloat stats[5] = {governor.averageFlushTime() / 1000.0f,
+                     governor.averageReadbackTime() / 1000.0f, player->cacheScale(),
+                     player->maxFrameRate(), static_cast<jfloat>(governor.levelChanges())};
+  env->SetFloatArrayRegion(values, 0, 5, stats);
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setPreroll(JNIEnv* env, jobject thiz,
+                                                            jlong lookaheadMillis,
+                                                            jlong memoryBudget) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->preroll.setConfig(lookaheadMillis * 1000, memoryBudget);
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_prerollStats(JNIEnv* env, jobject thiz,
+                                                              jlongArray values) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr || values == nullptr || env->GetArrayLength(values) < 3) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  auto& preroll = jPlayer->preroll;
+  jlong stats[3] = {preroll.prerollCount(), preroll.missedCount(), preroll.pendingBytes()};
+  env->SetLongArrayRegion(values, 0, 3, stats);
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_setAssetEviction(JNIEnv* env, jobject thiz,
+                                                                  jboolean enabled,
+                                                                  jlong marginMillis) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  jPlayer->residency.setConfig(enabled, marginMillis * 1000);
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGPlayer_assetStats(JNIEnv* env, jobject thiz,
+                                                            jobject file, jlongArray values) {
+  auto jPlayer = getJPAGPlayer(env, thiz);
+  if (jPlayer == nullptr || values == nullptr || env->GetArrayLength(values) < 5) {
+    return;
+  }
+  ID fileID = 0;
+  if (file != nullptr) {
+    auto pagFile = ToPAGLayerNativeObject(env, file);
+    if (pagFile == nullptr) {
+      return;
+    }
+    fileID = pagFile->uniqueID();
+  }
+  std::lock_guard<std::mutex> autoLock(jPlayer->stateLocker);
+  auto stats = jPlayer->residency.getStats(fileID);
+  jlong result[5] = {stats.residentBytes, stats.totalBytes, stats.residentCount,
+                     stats.totalCount, jPlayer->residency.evictionCount()};
+  env->SetLongArrayRegion(values, 0, 5, result);
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGPlayer_RenderThumbnail(
+    JNIEnv* env, jclass, jobject composition, jdouble progress, jint width, jint height,
+    jbyteArray pixels, jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGPlayer.RenderThumbnail");
+  return static_cast<jboolean>(JThumbnailRenderer::RenderToArray(
+      env, ToPAGCompositionNativeObject(env, composition), progress, width, height, pixels,
+      stride));
+}
+}
+
+static JNINativeMethod PAGPlayer_methods[] = {
+    {"getComposition", "()Lorg/libpag/PAGComposition;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_getComposition)},
+    {"setComposition", "(Lorg/libpag/PAGComposition;)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setComposition)},
+    {"nativeSetSurface", "(J)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_nativeSetSurface)},
+    {"videoEnabled", "()Z", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_videoEnabled)},
+    {"setVideoEnabled", "(Z)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setVideoEnabled)},
+    {"cacheEnabled", "()Z", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_cacheEnabled)},
+    {"setCacheEnabled", "(Z)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setCacheEnabled)},
+    {"useDiskCache", "()Z", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_useDiskCache)},
+    {"setUseDiskCache", "(Z)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setUseDiskCache)},
+    {"cacheScale", "()F", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_cacheScale)},
+    {"setCacheScale", "(F)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setCacheScale)},
+    {"maxFrameRate", "()F", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_maxFrameRate)},
+    {"setMaxFrameRate", "(F)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setMaxFrameRate)},
+    {"scaleMode", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_scaleMode)},
+    {"setScaleMode", "(I)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setScaleMode)},
+    {"nativeGetMatrix", "([F)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_nativeGetMatrix)},
+    {"nativeSetMatrix", "(FFFFFF)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_nativeSetMatrix)},
+    {"duration", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_duration)},
+    {"getProgress", "()D", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_getProgress)},
+    {"setProgress", "(D)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setProgress)},
+    {"currentFrame", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_currentFrame)},
+    {"prepare", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_prepare)},
+    {"flushAndFenceSync", "([J)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_flushAndFenceSync)},
+    {"waitSync", "(J)Z", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_waitSync)},
+    {"setScrubMode", "(ZFJ)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setScrubMode)},
+    {"scrubMode", "()Z", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_scrubMode)},
+    {"flushScrub", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_flushScrub)},
+    {"scrubRefineDelay", "()J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_scrubRefineDelay)},
+    {"setStaticFrames", "(Lorg/libpag/PAGStaticFrames;)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setStaticFrames)},
+    {"setQualityGovernor", "(ZF)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setQualityGovernor)},
+    {"qualityLevel", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_qualityLevel)},
+    {"qualityStats", "([F)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_qualityStats)},
+    {"setPreroll", "(JJ)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setPreroll)},
+    {"prerollStats", "([J)V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_prerollStats)},
+    {"setAssetEviction", "(ZJ)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_setAssetEviction)},
+    {"assetStats", "(Lorg/libpag/PAGFile;[J)V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_assetStats)},
+    {"getBounds", "(Lorg/libpag/PAGLayer;)Lorg/libpag/PAGRect;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_getBounds)},
+    {"hitTestPoint", "(Lorg/libpag/PAGLayer;FFZ)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_hitTestPoint)},
+    {"RenderThumbnail", "(Lorg/libpag/PAGComposition;DII[BI)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_RenderThumbnail)},
+    {"nativeRelease", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_nativeRelease)},
+    {"nativeFinalize", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_nativeFinalize)},
+    {"nativeSetup", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGPlayer_nativeSetup)},
+};
+
+namespace pag {
+bool RegisterPAGPlayerNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGPlayer", PAGPlayer_methods,
+                                     sizeof(PAGPlayer_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGPlayer_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
 }
+}  // namespace pag
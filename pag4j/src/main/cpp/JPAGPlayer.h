@@ -18,8 +18,27 @@
 
 #pragma once
 
+#include "JAssetResidency.h"
+#include "JNIHelper.h"
+#include "JPAGSurface.h"
+#include "JPrerollScheduler.h"
+#include "JQualityGovernor.h"
+#include "JStaticFrames.h"
 #include "pag/pag.h"
 
+/**
+ * The state of the scrub mode, in which PAGPlayer renders a reduced quality preview while the
+ * progress keeps changing, and re-renders the settled frame in full quality afterwards.
+ */
+struct ScrubState {
+  bool enabled = false;
+  float previewScale = 0.5f;
+  int64_t settleTime = 150000;
+  double lastProgress = -1;
+  int64_t lastChangeTime = 0;
+  bool previewShown = false;
+};
+
 class JPAGPlayer {
  public:
   explicit JPAGPlayer(std::shared_ptr<pag::PAGPlayer> pagPlayer) : pagPlayer(pagPlayer) {
@@ -35,7 +54,46 @@ class JPAGPlayer {
     pagPlayer = nullptr;
   }
 
+  /**
+   * Applies the cache scale and the maximum frame rate set by the user, reduced by the scrub
+   * preview and the quality governor. Must be called while holding stateLocker.
+   */
+  void applyQuality(pag::PAGPlayer* player) {
+    auto scale = cacheScale * governor.cacheScaleFactor();
+    if (scrub.enabled && scrub.previewShown) {
+      scale *= scrub.previewScale;
+    }
+    player->setCacheScale(scale);
+    player->setMaxFrameRate(governor.maxFrameRate(maxFrameRate));
+    // The same frame looks different now, it must not be skipped as a duplicate.
+    lastFlushedFrame = -1;
+  }
+
+  // The values set by the user, the player may currently use lower ones.
+  float cacheScale = 1.0f;
+  float maxFrameRate = 60.0f;
+  ScrubState scrub;
+  pag::JQualityGovernor governor;
+  pag::JPrerollScheduler preroll;
+  pag::JAssetResidency residency;
+  // The surface currently attached to the player, which reports its readback durations to the
+  // governor.
+  JPAGSurface* surface = nullptr;
+  // Set by setStaticFrames(), flushes are skipped while the player stays within a run of
+  // duplicate frames and neither its composition tree, its surface nor its settings have been
+  // changed since the last flush. Setters of the player reset lastFlushedFrame.
+  std::shared_ptr<pag::JStaticFrames> staticFrames;
+  int64_t lastFlushedFrame = -1;
+  uint64_t lastFlushedVersion = 0;
+  uint64_t lastFlushedSurfaceVersion = 0;
+  std::mutex stateLocker;
+
  private:
   std::shared_ptr<pag::PAGPlayer> pagPlayer;
   std::mutex locker;
 };
+
+/**
+ * Returns the native player of a Java PAGPlayer object, or nullptr if it has been released.
+ */
+JPAGPlayer* getJPAGPlayer(JNIEnv* env, jobject thiz);
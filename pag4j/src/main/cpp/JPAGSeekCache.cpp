@@ -0,0 +1,290 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JPAGSeekCache.h"
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+using namespace pag;
+
+std::unique_ptr<JPAGSeekCache> JPAGSeekCache::Make(std::shared_ptr<PAGComposition> composition,
+                                                   int width, int height, int capacity) {
+  if (composition == nullptr || width <= 0 || height <= 0 || capacity <= 0) {
+    return nullptr;
+  }
+  auto surface = PAGSurface::MakeOffscreen(width, height);
+  if (surface == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<JPAGSeekCache> cache(new JPAGSeekCache());
+  cache->player = std::make_shared<PAGPlayer>();
+  cache->player->setSurface(surface);
+  cache->player->setComposition(composition);
+  cache->surface = surface;
+  cache->_width = width;
+  cache->_height = height;
+  cache->capacity = static_cast<size_t>(capacity);
+  cache->_numFrames = CountFrames(composition);
+  cache->prefetchThread = std::thread(&JPAGSeekCache::prefetchLoop, cache.get());
+  return cache;
+}
+
+JPAGSeekCache::~JPAGSeekCache() {
+  {
+    std::lock_guard<std::mutex> autoLock(cacheLocker);
+    exiting = true;
+  }
+  condition.notify_all();
+  if (prefetchThread.joinable()) {
+    prefetchThread.join();
+  }
+}
+
+bool JPAGSeekCache::isCached(int64_t frame) {
+  std::lock_guard<std::mutex> autoLock(cacheLocker);
+  return frames.count(frame) > 0;
+}
+
+bool JPAGSeekCache::renderFrame(int64_t frame, std::vector<uint8_t>* pixels) {
+  PAG4J_TRACE_EVENT("pag", "PAGSeekCache::renderFrame");
+  player->setProgress(FrameToProgress(frame, _numFrames));
+  player->flush();
+  auto rowBytes = static_cast<size_t>(_width) * 4;
+  pixels->resize(rowBytes * _height);
+  return surface->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied, pixels->data(),
+                             rowBytes);
+}
+
+JPAGSeekCache::Pixels JPAGSeekCache::seekFrame(int64_t frame) {
+  std::lock_guard<std::mutex> autoLock(cacheLocker);
+  if (playhead >= 0 && frame != playhead) {
+    direction = frame > playhead ? 1 : -1;
+  }
+  playhead = frame;
+  auto pixels = findFrameLocked(frame);
+  if (pixels == nullptr) {
+    waitingReaders++;
+    return nullptr;
+  }
+  hits++;
+  seekVersion++;
+  condition.notify_all();
+  return pixels;
+}
+
+JPAGSeekCache::Pixels JPAGSeekCache::renderMissedFrame(int64_t frame) {
+  Pixels pixels = nullptr;
+  bool rendered = false;
+  {
+    std::lock_guard<std::mutex> renderLock(renderLocker);
+    {
+      // The worker may have prefetched the frame while we were waiting for the player.
+      std::lock_guard<std::mutex> autoLock(cacheLocker);
+      pixels = findFrameLocked(frame);
+    }
+    if (pixels == nullptr) {
+      auto buffer = std::make_shared<std::vector<uint8_t>>();
+      if (renderFrame(frame, buffer.get())) {
+        pixels = buffer;
+        rendered = true;
+      }
+    }
+  }
+  {
+    std::lock_guard<std::mutex> autoLock(cacheLocker);
+    if (rendered) {
+      misses++;
+      insertFrameLocked(frame, pixels);
+    } else if (pixels != nullptr) {
+      hits++;
+    }
+    waitingReaders--;
+    // Prefetching around the new playhead starts only after the requested frame is done.
+    seekVersion++;
+  }
+  condition.notify_all();
+  return pixels;
+}
+
+JPAGSeekCache::Pixels JPAGSeekCache::findFrameLocked(int64_t frame) {
+  auto result = frames.find(frame);
+  if (result == frames.end()) {
+    return nullptr;
+  }
+  recentFrames.splice(recentFrames.begin(), recentFrames, result->second.position);
+  return result->second.pixels;
+}
+
+void JPAGSeekCache::insertFrame(int64_t frame, Pixels pixels) {
+  std::lock_guard<std::mutex> autoLock(cacheLocker);
+  insertFrameLocked(frame, std::move(pixels));
+}
+
+void JPAGSeekCache::insertFrameLocked(int64_t frame, Pixels pixels) {
+  if (frames.count(frame) > 0) {
+    return;
+  }
+  while (frames.size() >= capacity && !recentFrames.empty()) {
+    frames.erase(recentFrames.back());
+    recentFrames.pop_back();
+  }
+  recentFrames.push_front(frame);
+  frames[frame] = {std::move(pixels), recentFrames.begin()};
+}
+
+void JPAGSeekCache::prefetchLoop() {
+  JTrace::SetThreadName("PAGSeekCache");
+  uint64_t handledVersion = 0;
+  while (true) {
+    int64_t start = 0;
+    int64_t count = 1;
+    uint64_t version = 0;
+    {
+      std::unique_lock<std::mutex> autoLock(cacheLocker);
+      condition.wait(autoLock, [&] {
+        return exiting || (seekVersion != handledVersion && waitingReaders == 0);
+      });
+      if (exiting) {
+        return;
+      }
+      version = handledVersion = seekVersion;
+      // Keep half of the cache for the frames behind the playhead so that reversing the scrub
+      // direction hits the cache as well.
+      auto window = static_cast<int64_t>(std::max<size_t>(1, capacity / 2));
+      if (direction > 0) {
+        start = playhead + 1;
+      } else {
+        start = std::max<int64_t>(0, playhead - window);
+      }
+      count = std::min<int64_t>(window, _numFrames);
+    }
+    // Frames are always rendered in ascending order, also when scrubbing backwards. Video
+    // sequences decode forward from their previous keyframe, so one forward pass over the window
+    // decodes every group of pictures only once instead of once per frame.
+    for (int64_t frame = start; frame < start + count && frame < _numFrames; frame++) {
+      {
+        std::lock_guard<std::mutex> autoLock(cacheLocker);
+        // A reader waiting for a missed frame takes precedence over prefetching.
+        if (exiting || seekVersion != version || waitingReaders > 0) {
+          break;
+        }
+      }
+      if (isCached(frame)) {
+        continue;
+      }
+      auto pixels = std::make_shared<std::vector<uint8_t>>();
+      bool success = false;
+      {
+        std::lock_guard<std::mutex> autoLock(renderLocker);
+        success = renderFrame(frame, pixels.get());
+      }
+      if (success) {
+        insertFrame(frame, std::move(pixels));
+      }
+    }
+  }
+}
+
+namespace pag {
+static jfieldID PAGSeekCache_nativeContext;
+}
+
+static JPAGSeekCache* GetSeekCache(JNIEnv* env, jobject thiz) {
+  return reinterpret_cast<JPAGSeekCache*>(env->GetLongField(thiz, PAGSeekCache_nativeContext));
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGSeekCache_SetupCache(JNIEnv* env, jclass,
+                                                                jobject composition, jint width,
+                                                                jint height, jint capacity) {
+  PAG4J_TRACE_EVENT("jni", "PAGSeekCache.SetupCache");
+  auto cache = JPAGSeekCache::Make(ToPAGCompositionNativeObject(env, composition), width, height,
+                                   capacity);
+  if (cache == nullptr) {
+    LOGE("PAGSeekCache.SetupCache(): Failed to create the seek cache!");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(cache.release());
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGSeekCache_nativeRelease(JNIEnv* env, jobject thiz) {
+  delete GetSeekCache(env, thiz);
+  env->SetLongField(thiz, PAGSeekCache_nativeContext, 0);
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGSeekCache_numFrames(JNIEnv* env, jobject thiz) {
+  auto cache = GetSeekCache(env, thiz);
+  return cache != nullptr ? cache->numFrames() : 0;
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGSeekCache_hitCount(JNIEnv* env, jobject thiz) {
+  auto cache = GetSeekCache(env, thiz);
+  return cache != nullptr ? cache->hitCount() : 0;
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGSeekCache_missCount(JNIEnv* env, jobject thiz) {
+  auto cache = GetSeekCache(env, thiz);
+  return cache != nullptr ? cache->missCount() : 0;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGSeekCache_readFrame(JNIEnv* env, jobject thiz,
+                                                                  jlong frame, jbyteArray pixels,
+                                                                  jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGSeekCache.readFrame");
+  auto cache = GetSeekCache(env, thiz);
+  if (cache == nullptr || pixels == nullptr) {
+    return JNI_FALSE;
+  }
+  auto width = cache->width();
+  auto height = cache->height();
+  if (stride < width * 4 ||
+      env->GetArrayLength(pixels) < static_cast<jlong>(stride) * (height - 1) + width * 4) {
+    return JNI_FALSE;
+  }
+  auto success = cache->readFrame(frame, [&](const uint8_t* source) {
+    for (int row = 0; row < height; row++) {
+      env->SetByteArrayRegion(pixels, row * stride, width * 4,
+                              reinterpret_cast<const jbyte*>(source) + row * width * 4);
+    }
+  });
+  return static_cast<jboolean>(success);
+}
+}
+
+static JNINativeMethod PAGSeekCache_methods[] = {
+    {"SetupCache", "(Lorg/libpag/PAGComposition;III)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGSeekCache_SetupCache)},
+    {"numFrames", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGSeekCache_numFrames)},
+    {"readFrame", "(J[BI)Z", reinterpret_cast<void*>(Java_org_libpag_PAGSeekCache_readFrame)},
+    {"hitCount", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGSeekCache_hitCount)},
+    {"missCount", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGSeekCache_missCount)},
+    {"nativeRelease", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGSeekCache_nativeRelease)},
+};
+
+namespace pag {
+bool RegisterPAGSeekCacheNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGSeekCache", PAGSeekCache_methods,
+                                     sizeof(PAGSeekCache_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGSeekCache_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
@@ -0,0 +1,126 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <thread>
+#include <unordered_map>
+#include "pag/pag.h"
+
+/**
+ * Renders a composition for timeline scrubbing. Rendered frames are kept in a bounded LRU cache,
+ * and a worker thread prefetches the frames ahead of the playhead in the scrub direction.
+ */
+class JPAGSeekCache {
+ public:
+  static std::unique_ptr<JPAGSeekCache> Make(std::shared_ptr<pag::PAGComposition> composition,
+                                             int width, int height, int capacity);
+
+  ~JPAGSeekCache();
+
+  int width() const {
+    return _width;
+  }
+
+  int height() const {
+    return _height;
+  }
+
+  int64_t numFrames() const {
+    return _numFrames;
+  }
+
+  int64_t hitCount() {
+    std::lock_guard<std::mutex> autoLock(cacheLocker);
+    return hits;
+  }
+
+  int64_t missCount() {
+    std::lock_guard<std::mutex> autoLock(cacheLocker);
+    return misses;
+  }
+
+  /**
+   * Moves the playhead to the frame and copies its tightly packed RGBA pixels by calling the
+   * copier. The frame is rendered synchronously if it is not cached. Returns false if the frame is
+   * out of range or could not be rendered.
+   */
+  template <typename Copier>
+  bool readFrame(int64_t frame, Copier&& copier) {
+    if (frame < 0 || frame >= _numFrames) {
+      return false;
+    }
+    auto pixels = seekFrame(frame);
+    if (pixels == nullptr) {
+      pixels = renderMissedFrame(frame);
+      if (pixels == nullptr) {
+        return false;
+      }
+    }
+    // Cached pixels are never modified, so they are copied without holding any lock.
+    copier(pixels->data());
+    return true;
+  }
+
+ private:
+  using Pixels = std::shared_ptr<const std::vector<uint8_t>>;
+
+  struct CachedFrame {
+    Pixels pixels = nullptr;
+    std::list<int64_t>::iterator position = {};
+  };
+
+  std::shared_ptr<pag::PAGPlayer> player = nullptr;
+  std::shared_ptr<pag::PAGSurface> surface = nullptr;
+  int _width = 0;
+  int _height = 0;
+  size_t capacity = 0;
+  int64_t _numFrames = 0;
+  std::mutex renderLocker = {};
+
+  std::mutex cacheLocker = {};
+  std::condition_variable condition = {};
+  std::list<int64_t> recentFrames = {};
+  std::unordered_map<int64_t, CachedFrame> frames = {};
+  int64_t playhead = -1;
+  int direction = 1;
+  uint64_t seekVersion = 0;
+  int waitingReaders = 0;
+  int64_t hits = 0;
+  int64_t misses = 0;
+  bool exiting = false;
+  std::thread prefetchThread = {};
+
+  JPAGSeekCache() = default;
+
+  /**
+   * Moves the playhead to the frame and returns its cached pixels. On a miss, the caller is
+   * registered as a waiting reader and must call renderMissedFrame(), the worker stays off the
+   * player until then.
+   */
+  Pixels seekFrame(int64_t frame);
+  Pixels renderMissedFrame(int64_t frame);
+  Pixels findFrameLocked(int64_t frame);
+  void insertFrameLocked(int64_t frame, Pixels pixels);
+  bool isCached(int64_t frame);
+  bool renderFrame(int64_t frame, std::vector<uint8_t>* pixels);
+  void insertFrame(int64_t frame, Pixels pixels);
+  void prefetchLoop();
+};
@@ -17,7 +17,10 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "JPAGSurface.h"
+#include <chrono>
+#include "JFrameFingerprint.h"
 #include "JNIHelper.h"
+#include "JTrace.h"
 
 namespace pag {
 static jfieldID PAGSurface_nativeSurface;
@@ -34,12 +37,42 @@ std::shared_ptr<PAGSurface> getPAGSurface(JNIEnv* env, jobject thiz) {
   return pagSurface->get();
 }
 
-extern "C" {
-
-JNIEXPORT void JNICALL Java_org_libpag_PAGSurface_nativeInit(JNIEnv* env, jclass clazz) {
-  PAGSurface_nativeSurface = env->GetFieldID(clazz, "nativeSurface", "J");
+static void MarkSurfaceChanged(JNIEnv* env, jobject thiz) {
+  auto pagSurface =
+      reinterpret_cast<JPAGSurface*>(env->GetLongField(thiz, PAGSurface_nativeSurface));
+  if (pagSurface != nullptr) {
+    // Players attached to the surface must draw their next flush even within static frames.
+    pagSurface->contentVersion++;
+  }
 }
 
+/**
+ * Adds the time spent in its scope to the readback time of the surface, which is consumed by the
+ * quality governor of the player it is attached to.
+ */
+class ReadbackTimer {
+ public:
+  ReadbackTimer(JNIEnv* env, jobject thiz)
+      : surface(reinterpret_cast<JPAGSurface*>(env->GetLongField(thiz, PAGSurface_nativeSurface))),
+        startTime(std::chrono::steady_clock::now()) {
+  }
+
+  ~ReadbackTimer() {
+    if (surface != nullptr) {
+      surface->readbackTime += std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - startTime)
+                                   .count();
+    }
+  }
+
+ private:
+  JPAGSurface* surface = nullptr;
+  std::chrono::steady_clock::time_point startTime;
+  TraceScope traceScope = {"pag", "PAGSurface::readPixels"};
+};
+
+extern "C" {
+
 JNIEXPORT void JNICALL Java_org_libpag_PAGSurface_nativeRelease(JNIEnv* env, jobject thiz) {
   auto jPAGSurface =
       reinterpret_cast<JPAGSurface*>(env->GetLongField(thiz, PAGSurface_nativeSurface));
@@ -71,32 +104,39 @@ JNIEXPORT jint JNICALL Java_org_libpag_PAGSurface_height(JNIEnv* env, jobject th
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGSurface_updateSize(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGSurface.updateSize");
   auto surface = getPAGSurface(env, thiz);
   if (surface == nullptr) {
     return;
   }
   surface->updateSize();
+  MarkSurfaceChanged(env, thiz);
 }
 
 JNIEXPORT jboolean JNICALL Java_org_libpag_PAGSurface_clearAll(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGSurface.clearAll");
   auto surface = getPAGSurface(env, thiz);
   if (surface == nullptr) {
     return static_cast<jboolean>(false);
   }
   auto changed = static_cast<jboolean>(surface->clearAll());
+  MarkSurfaceChanged(env, thiz);
   return changed;
 }
 
 JNIEXPORT void JNICALL Java_org_libpag_PAGSurface_freeCache(JNIEnv* env, jobject thiz) {
+  PAG4J_TRACE_EVENT("jni", "PAGSurface.freeCache");
   auto surface = getPAGSurface(env, thiz);
   if (surface == nullptr) {
     return;
   }
   surface->freeCache();
+  MarkSurfaceChanged(env, thiz);
 }
 
 JNIEXPORT jlong JNICALL Java_org_libpag_PAGSurface_SetupOffscreen(JNIEnv*, jclass, jint width,
                                                                   jint height) {
+  PAG4J_TRACE_EVENT("jni", "PAGSurface.SetupOffscreen");
   auto surface = PAGSurface::MakeOffscreen(width, height);
   if (surface == nullptr) {
     LOGE("PAGSurface.SetupOffscreen(): Failed to create a offscreen PAGSurface!");
@@ -105,8 +145,9 @@ JNIEXPORT jlong JNICALL Java_org_libpag_PAGSurface_SetupOffscreen(JNIEnv*, jclas
   return reinterpret_cast<jlong>(new JPAGSurface(surface));
 }
 
-JNIEXPORT jboolean JNICALL Java_org_libpag_PAGSurface_copyPixelsTo(JNIEnv* env, jobject thiz,
-                                                                   jbyteArray pixels, jint stride) {
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGSurface_nativeCopyPixelsTo(
+    JNIEnv* env, jobject thiz, jbyteArray pixels, jint stride, jlongArray fingerprint) {
+  PAG4J_TRACE_EVENT("jni", "PAGSurface.copyPixelsTo");
   if (thiz == nullptr || pixels == nullptr) {
     return false;
   }
@@ -118,9 +159,129 @@ JNIEXPORT jboolean JNICALL Java_org_libpag_PAGSurface_copyPixelsTo(JNIEnv* env,
   if (pixelBuffer == nullptr) {
     return false;
   }
-  bool success = surface->readPixels(pag::ColorType::RGBA_8888, pag::AlphaType::Premultiplied,
-                                     pixelBuffer, stride);
+  bool success = false;
+  {
+    // Only the readback is reported to the quality governor, hashing is not part of it.
+    ReadbackTimer timer(env, thiz);
+    success = surface->readPixels(pag::ColorType::RGBA_8888, pag::AlphaType::Premultiplied,
+                                  pixelBuffer, stride);
+  }
+  if (success) {
+    // Hashing right after the copy reads the pixels while they are still in the CPU caches.
+    WriteFingerprint(env, fingerprint, reinterpret_cast<const uint8_t*>(pixelBuffer),
+                     surface->width(), surface->height(), static_cast<size_t>(stride));
+  }
   env->ReleaseByteArrayElements(pixels, pixelBuffer, 0);
   return success;
 }
-}
\ No newline at end of file
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGSurface_nativeCopyPixelsToBuffer(
+    JNIEnv* env, jobject thiz, jobject pixels, jint stride, jlongArray fingerprint) {
+  PAG4J_TRACE_EVENT("jni", "PAGSurface.nativeCopyPixelsToBuffer");
+  auto surface = getPAGSurface(env, thiz);
+  if (surface == nullptr || pixels == nullptr) {
+    return false;
+  }
+  auto pixelBuffer = env->GetDirectBufferAddress(pixels);
+  auto capacity = env->GetDirectBufferCapacity(pixels);
+  auto rowBytes = static_cast<jlong>(surface->width()) * 4;
+  auto height = static_cast<jlong>(surface->height());
+  if (pixelBuffer == nullptr || stride < rowBytes || height <= 0 ||
+      capacity < static_cast<jlong>(stride) * (height - 1) + rowBytes) {
+    return false;
+  }
+  bool success = false;
+  {
+    // Only the readback is reported to the quality governor, hashing is not part of it.
+    ReadbackTimer timer(env, thiz);
+    success = surface->readPixels(pag::ColorType::RGBA_8888, pag::AlphaType::Premultiplied,
+                                  pixelBuffer, stride);
+  }
+  if (success) {
+    WriteFingerprint(env, fingerprint, static_cast<const uint8_t*>(pixelBuffer), surface->width(),
+                     surface->height(), static_cast<size_t>(stride));
+  }
+  return success;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_org_libpag_PAGSurface_copyDirtyPixelsTo(JNIEnv* env,
+                                                                            jobject thiz,
+                                                                            jbyteArray pixels,
+                                                                            jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGSurface.copyDirtyPixelsTo");
+  if (thiz == nullptr || pixels == nullptr) {
+    return nullptr;
+  }
+  auto jPAGSurface =
+      reinterpret_cast<JPAGSurface*>(env->GetLongField(thiz, PAGSurface_nativeSurface));
+  auto surface = jPAGSurface != nullptr ? jPAGSurface->get() : nullptr;
+  if (surface == nullptr) {
+    return nullptr;
+  }
+  auto width = surface->width();
+  auto height = surface->height();
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  if (width <= 0 || height <= 0 || stride < static_cast<jlong>(rowBytes) ||
+      env->GetArrayLength(pixels) <
+          static_cast<jlong>(stride) * (height - 1) + static_cast<jlong>(rowBytes)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> autoLock(jPAGSurface->readbackLocker);
+  ReadbackTimer timer(env, thiz);
+  auto& frame = jPAGSurface->readbackBuffer;
+  frame.resize(rowBytes * height);
+  if (!surface->readPixels(pag::ColorType::RGBA_8888, pag::AlphaType::Premultiplied, frame.data(),
+                           rowBytes)) {
+    jPAGSurface->dirtyRegion.reset();
+    return nullptr;
+  }
+  auto rects = jPAGSurface->dirtyRegion.update(&frame, width, height);
+  auto source = jPAGSurface->dirtyRegion.lastFrame().data();
+  for (auto& rect : rects) {
+    for (int row = rect.y; row < rect.y + rect.height; row++) {
+      auto offset = static_cast<size_t>(row) * rowBytes + static_cast<size_t>(rect.x) * 4;
+      env->SetByteArrayRegion(pixels, row * stride + rect.x * 4, rect.width * 4,
+                              reinterpret_cast<const jbyte*>(source + offset));
+    }
+  }
+  jclass RectClass = env->FindClass("org/libpag/PAGRect");
+  auto result = env->NewObjectArray(static_cast<jsize>(rects.size()), RectClass, nullptr);
+  for (size_t i = 0; i < rects.size(); i++) {
+    auto& rect = rects[i];
+    auto rectObject = MakeRectFObject(env, rect.x, rect.y, rect.width, rect.height);
+    env->SetObjectArrayElement(result, static_cast<jsize>(i), rectObject);
+    env->DeleteLocalRef(rectObject);
+  }
+  return result;
+}
+}
+
+static JNINativeMethod PAGSurface_methods[] = {
+    {"SetupOffscreen", "(II)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGSurface_SetupOffscreen)},
+    {"width", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGSurface_width)},
+    {"height", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGSurface_height)},
+    {"updateSize", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGSurface_updateSize)},
+    {"clearAll", "()Z", reinterpret_cast<void*>(Java_org_libpag_PAGSurface_clearAll)},
+    {"freeCache", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGSurface_freeCache)},
+    {"nativeCopyPixelsTo", "([BI[J)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGSurface_nativeCopyPixelsTo)},
+    {"nativeCopyPixelsToBuffer", "(Ljava/nio/ByteBuffer;I[J)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGSurface_nativeCopyPixelsToBuffer)},
+    {"copyDirtyPixelsTo", "([BI)[Lorg/libpag/PAGRect;",
+     reinterpret_cast<void*>(Java_org_libpag_PAGSurface_copyDirtyPixelsTo)},
+    {"nativeRelease", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGSurface_nativeRelease)},
+    {"nativeFinalize", "()V", reinterpret_cast<void*>(Java_org_libpag_PAGSurface_nativeFinalize)},
+};
+
+namespace pag {
+bool RegisterPAGSurfaceNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGSurface", PAGSurface_methods,
+                                     sizeof(PAGSurface_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGSurface_nativeSurface = env->GetFieldID(clazz, "nativeSurface", "J");
+  return true;
+}
+}  // namespace pag
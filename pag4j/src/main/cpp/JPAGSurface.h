@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <atomic>
+#include "JDirtyRegion.h"
 #include "pag/pag.h"
 
 class JPAGSurface {
@@ -35,6 +37,18 @@ class JPAGSurface {
     pagSurface = nullptr;
   }
 
+  /**
+   * Pixels read back by copyDirtyPixelsTo() and the regions changed since the previous call. Must
+   * be accessed while holding readbackLocker.
+   */
+  std::vector<uint8_t> readbackBuffer;
+  // The accumulated duration of readbacks in microseconds since the governor last consumed it.
+  std::atomic<int64_t> readbackTime = {0};
+  // Bumped whenever the surface is resized, cleared or has its caches freed through the bindings.
+  std::atomic<uint64_t> contentVersion = {0};
+  pag::JDirtyRegion dirtyRegion;
+  std::mutex readbackLocker;
+
  private:
   std::shared_ptr<pag::PAGSurface> pagSurface;
   std::mutex locker;
@@ -0,0 +1,111 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JPrerollScheduler.h"
+#include <algorithm>
+#include "JAssetSpans.h"
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+namespace pag {
+void JPrerollScheduler::setConfig(int64_t lookahead, int64_t budget) {
+  lookaheadTime = std::max<int64_t>(0, lookahead);
+  memoryBudget = std::max<int64_t>(0, budget);
+  composition.reset();
+  events.clear();
+  reset();
+}
+
+void JPrerollScheduler::reset() {
+  for (auto& event : events) {
+    event.prerolled = false;
+  }
+  _pendingBytes = 0;
+  lastTime = -1;
+}
+
+void JPrerollScheduler::collectEvents(std::shared_ptr<PAGComposition> root) {
+  events.clear();
+  for (auto& span : CollectAssetSpans(root)) {
+    AssetEvent event = {};
+    event.startTime = span.startTime;
+    event.bytes = span.bytes;
+    events.push_back(event);
+  }
+}
+
+void JPrerollScheduler::onFlush(PAGPlayer* player) {
+  auto root = player->getComposition();
+  if (root == nullptr) {
+    return;
+  }
+  auto version = ContentVersion(root);
+  if (root != composition.lock() || version != eventsVersion) {
+    composition = root;
+    eventsVersion = version;
+    collectEvents(root);
+    reset();
+  }
+  auto duration = player->duration();
+  if (events.empty() || duration <= 0) {
+    return;
+  }
+  auto progress = player->getProgress();
+  auto now = static_cast<int64_t>(progress * static_cast<double>(duration));
+  if (now < lastTime) {
+    // The playhead looped or was moved back, the earlier prerolls may have been evicted since.
+    reset();
+  }
+  std::vector<int64_t> prerollTimes = {};
+  for (auto& event : events) {
+    if (lastTime >= 0 && event.startTime > lastTime && event.startTime <= now) {
+      if (event.prerolled) {
+        // The asset is visible now, its memory is owned by the frame caches of libpag.
+        _pendingBytes -= event.bytes;
+        event.prerolled = false;
+      } else {
+        _missedCount++;
+      }
+      continue;
+    }
+    if (event.prerolled || event.startTime <= now || event.startTime > now + lookaheadTime ||
+        _pendingBytes + event.bytes > memoryBudget) {
+      continue;
+    }
+    event.prerolled = true;
+    _pendingBytes += event.bytes;
+    _prerollCount++;
+    if (prerollTimes.empty() || prerollTimes.back() != event.startTime) {
+      prerollTimes.push_back(event.startTime);
+    }
+  }
+  lastTime = now;
+  if (prerollTimes.empty()) {
+    return;
+  }
+  PAG4J_TRACE_EVENT("pag", "PAGPlayer::prepare");
+  // Half a frame past the start time keeps rounding from landing on the frame before the asset.
+  auto halfFrame = static_cast<int64_t>(500000.0 / std::max(1.0f, root->frameRate()));
+  for (auto time : prerollTimes) {
+    player->setProgress(std::min(1.0, static_cast<double>(time + halfFrame) / duration));
+    player->prepare();
+  }
+  player->setProgress(progress);
+}
+}  // namespace pag
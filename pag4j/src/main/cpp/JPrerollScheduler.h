@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * Looks ahead of the playhead of a PAGPlayer for image layers and sequence compositions (video or
+ * bitmap sequences, which have no child layers) that are about to become visible, and calls
+ * PAGPlayer::prepare() at their start time. libpag then decodes them on its own worker threads
+ * while the current frames keep rendering, instead of on the first frame that shows them.
+ */
+class JPrerollScheduler {
+ public:
+  bool enabled() const {
+    return lookaheadTime > 0;
+  }
+
+  /**
+   * Sets how far ahead to look in microseconds, 0 disables the preroll. The memory budget bounds
+   * the estimated decoded size of the assets prerolled but not yet visible, in bytes.
+   */
+  void setConfig(int64_t lookaheadTime, int64_t memoryBudget);
+
+  /**
+   * Called after every flush of the player, must run on the thread that renders it.
+   */
+  void onFlush(PAGPlayer* player);
+
+  int64_t prerollCount() const {
+    return _prerollCount;
+  }
+
+  /**
+   * The number of assets that became visible without having been prerolled, because the lookahead
+   * was too short, the budget was exhausted or the playhead jumped.
+   */
+  int64_t missedCount() const {
+    return _missedCount;
+  }
+
+  int64_t pendingBytes() const {
+    return _pendingBytes;
+  }
+
+  /**
+   * Forgets the prerolls done so far, such as after the caches of the player were freed.
+   */
+  void reset();
+
+ private:
+  struct AssetEvent {
+    int64_t startTime = 0;
+    int64_t bytes = 0;
+    bool prerolled = false;
+  };
+
+  int64_t lookaheadTime = 0;
+  int64_t memoryBudget = 0;
+  std::weak_ptr<PAGComposition> composition;
+  uint64_t eventsVersion = 0;
+  std::vector<AssetEvent> events = {};
+  int64_t lastTime = -1;
+  int64_t _prerollCount = 0;
+  int64_t _missedCount = 0;
+  int64_t _pendingBytes = 0;
+
+  void collectEvents(std::shared_ptr<PAGComposition> root);
+};
+}  // namespace pag
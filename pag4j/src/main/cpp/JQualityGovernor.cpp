@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JQualityGovernor.h"
+
+namespace pag {
+struct QualityLevel {
+  float cacheScale;
+  // The fraction of the maximum frame rate set by the user, so that the first levels never cap
+  // it, whatever it is.
+  float frameRateScale;
+};
+
+static constexpr QualityLevel QualityLevels[] = {
+    {1.0f, 1.0f}, {0.75f, 1.0f}, {0.5f, 1.0f}, {0.5f, 0.5f}, {0.35f, 0.4f},
+};
+static constexpr int NumQualityLevels = sizeof(QualityLevels) / sizeof(QualityLevels[0]);
+// The weight of the latest frame in the moving averages.
+static constexpr float AverageWeight = 0.2f;
+// Degrade quickly when frames are dropped, but only recover after a longer stable period so that
+// the levels do not oscillate around the budget.
+static constexpr int DegradeFrames = 8;
+static constexpr int RecoverFrames = 60;
+static constexpr float RecoverRatio = 0.6f;
+
+void JQualityGovernor::setEnabled(bool enabled, float targetFrameRate) {
+  _enabled = enabled && targetFrameRate > 0;
+  frameBudget = _enabled ? 1000000.0f / targetFrameRate : 0;
+  flushAverage = 0;
+  readbackAverage = 0;
+  overBudgetFrames = 0;
+  underBudgetFrames = 0;
+  _level = 0;
+}
+
+bool JQualityGovernor::onFrame(int64_t flushTime, int64_t readbackTime) {
+  if (!_enabled) {
+    return false;
+  }
+  flushAverage += (static_cast<float>(flushTime) - flushAverage) * AverageWeight;
+  readbackAverage += (static_cast<float>(readbackTime) - readbackAverage) * AverageWeight;
+  auto frameTime = flushAverage + readbackAverage;
+  auto oldLevel = _level;
+  if (frameTime > frameBudget) {
+    underBudgetFrames = 0;
+    if (++overBudgetFrames >= DegradeFrames && _level < NumQualityLevels - 1) {
+      _level++;
+    }
+  } else if (frameTime < frameBudget * RecoverRatio) {
+    overBudgetFrames = 0;
+    if (++underBudgetFrames >= RecoverFrames && _level > 0) {
+      _level--;
+    }
+  } else {
+    overBudgetFrames = 0;
+    underBudgetFrames = 0;
+  }
+  if (_level == oldLevel) {
+    return false;
+  }
+  overBudgetFrames = 0;
+  underBudgetFrames = 0;
+  _levelChanges++;
+  return true;
+}
+
+float JQualityGovernor::cacheScaleFactor() const {
+  return _enabled ? QualityLevels[_level].cacheScale : 1.0f;
+}
+
+float JQualityGovernor::maxFrameRate(float userMaxFrameRate) const {
+  if (!_enabled) {
+    return userMaxFrameRate;
+  }
+  return userMaxFrameRate * QualityLevels[_level].frameRateScale;
+}
+}  // namespace pag
@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+namespace pag {
+/**
+ * Watches the measured flush and readback durations of a PAGPlayer against a frame budget and
+ * picks a quality level. Each level lowers the cache scale or the maximum frame rate, a level is
+ * only changed after the frame time has stayed out of the budget for a number of frames.
+ */
+class JQualityGovernor {
+ public:
+  bool enabled() const {
+    return _enabled;
+  }
+
+  void setEnabled(bool enabled, float targetFrameRate);
+
+  /**
+   * Records the timings of a frame in microseconds, returns true if the quality level changed.
+   */
+  bool onFrame(int64_t flushTime, int64_t readbackTime);
+
+  int level() const {
+    return _level;
+  }
+
+  int levelChanges() const {
+    return _levelChanges;
+  }
+
+  float averageFlushTime() const {
+    return flushAverage;
+  }
+
+  float averageReadbackTime() const {
+    return readbackAverage;
+  }
+
+  /**
+   * The factor applied to the cache scale set by the user at the current level.
+   */
+  float cacheScaleFactor() const;
+
+  /**
+   * The maximum frame rate at the current level, which never exceeds the one set by the user.
+   */
+  float maxFrameRate(float userMaxFrameRate) const;
+
+ private:
+  bool _enabled = false;
+  float frameBudget = 0;
+  float flushAverage = 0;
+  float readbackAverage = 0;
+  int overBudgetFrames = 0;
+  int underBudgetFrames = 0;
+  int _level = 0;
+  int _levelChanges = 0;
+};
+}  // namespace pag
@@ -0,0 +1,432 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JRenderClient.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+using namespace pag;
+
+#ifndef _WIN32
+std::unique_ptr<JRenderClient> JRenderClient::Connect(const std::string& socketPath) {
+  if (socketPath.empty() || socketPath.size() > MaxSocketPathLength) {
+    return nullptr;
+  }
+  auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+#ifdef SO_NOSIGPIPE
+  int noSigPipe = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return nullptr;
+  }
+  return std::unique_ptr<JRenderClient>(new JRenderClient(fd));
+}
+
+JRenderClient::~JRenderClient() {
+  if (fd >= 0) {
+    RenderRequest request = {};
+    request.command = RenderCommand::Close;
+    WriteFully(fd, &request, sizeof(request));
+    close(fd);
+  }
+  unmapRing();
+}
+
+bool JRenderClient::request(const RenderRequest& request, const void* payload, RenderReply* reply,
+                            std::string* replyPayload) {
+  if (fd < 0) {
+    return false;
+  }
+  std::string unusedPayload = {};
+  if (!WriteFully(fd, &request, sizeof(request)) ||
+      !WriteFully(fd, payload, request.payloadSize) || !ReadFully(fd, reply, sizeof(*reply)) ||
+      !ReadPayload(fd, reply->payloadSize,
+                   replyPayload != nullptr ? replyPayload : &unusedPayload)) {
+    // The server has crashed or closed the session, every later request fails immediately.
+    LOGE("JRenderClient: Lost the connection to the render server!");
+    close(fd);
+    fd = -1;
+    return false;
+  }
+  return true;
+}
+
+bool JRenderClient::handleLoadReply(const RenderReply& reply) {
+  if (reply.status != RenderStatus::OK) {
+    return false;
+  }
+  _fileWidth = static_cast<int>(reply.values[0]);
+  _fileHeight = static_cast<int>(reply.values[1]);
+  _duration = reply.values[2];
+  _frameRate = static_cast<float>(reply.value);
+  _numFrames = CountFrames(_duration, _frameRate);
+  return true;
+}
+
+bool JRenderClient::loadFile(const std::string& path) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  RenderRequest request = {};
+  request.command = RenderCommand::LoadFile;
+  request.payloadSize = static_cast<uint32_t>(path.size());
+  RenderReply reply = {};
+  return this->request(request, path.data(), &reply, nullptr) && handleLoadReply(reply);
+}
+
+bool JRenderClient::loadData(const void* data, size_t length) {
+  if (length > MaxPayloadSize) {
+    return false;
+  }
+  std::lock_guard<std::mutex> autoLock(locker);
+  RenderRequest request = {};
+  request.command = RenderCommand::LoadData;
+  request.payloadSize = static_cast<uint32_t>(length);
+  RenderReply reply = {};
+  return this->request(request, data, &reply, nullptr) && handleLoadReply(reply);
+}
+
+bool JRenderClient::setupRing(int width, int height, int slotCount) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  unmapRing();
+  RenderRequest request = {};
+  request.command = RenderCommand::SetupRing;
+  request.args[0] = width;
+  request.args[1] = height;
+  request.args[2] = slotCount;
+  RenderReply reply = {};
+  std::string name = {};
+  if (!this->request(request, nullptr, &reply, &name) || reply.status != RenderStatus::OK) {
+    return false;
+  }
+  auto shmFD = shm_open(name.c_str(), O_RDWR, 0600);
+  if (shmFD < 0) {
+    return false;
+  }
+  // Nobody else needs the name, unlinking it now frees the memory even if both processes crash.
+  shm_unlink(name.c_str());
+  auto size = RingMappingSize(width, height, slotCount);
+  auto mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, shmFD, 0);
+  close(shmFD);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  auto header = static_cast<RingHeader*>(mapping);
+  if (header->magic != RingMagic || header->width != width || header->height != height ||
+      header->slotCount != slotCount) {
+    munmap(mapping, size);
+    return false;
+  }
+  ring = header;
+  ringSize = size;
+  return true;
+}
+
+int JRenderClient::renderFrame(int64_t frame) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  if (ring == nullptr || _numFrames <= 0) {
+    return -1;
+  }
+  RenderRequest request = {};
+  request.command = RenderCommand::RenderFrame;
+  request.args[0] = frame;
+  request.progress = FrameToProgress(frame, _numFrames);
+  RenderReply reply = {};
+  if (!this->request(request, nullptr, &reply, nullptr) || reply.status != RenderStatus::OK) {
+    return -1;
+  }
+  auto slot = static_cast<int>(reply.values[0]);
+  if (slot < 0 || slot >= ring->slotCount ||
+      ring->states[slot].load(std::memory_order_acquire) != RingSlotReady) {
+    return -1;
+  }
+  return slot;
+}
+
+void JRenderClient::releaseSlot(int slot) {
+  std::lock_guard<std::mutex> autoLock(locker);
+  if (ring != nullptr && slot >= 0 && slot < ring->slotCount) {
+    ring->states[slot].store(RingSlotFree, std::memory_order_release);
+  }
+}
+
+bool JRenderClient::copySlot(int slot, uint8_t* pixels, size_t rowBytes, size_t capacity) {
+  // Holding the lock keeps setupRing() and the destructor from unmapping or resizing the ring
+  // meanwhile, so the buffer is checked against the ring that is copied.
+  std::lock_guard<std::mutex> autoLock(locker);
+  if (ring == nullptr || slot < 0 || slot >= ring->slotCount ||
+      ring->states[slot].load(std::memory_order_acquire) != RingSlotReady) {
+    return false;
+  }
+  auto slotRowBytes = static_cast<size_t>(ring->width) * 4;
+  auto height = static_cast<uint64_t>(ring->height);
+  if (rowBytes < slotRowBytes || height == 0 ||
+      capacity < static_cast<uint64_t>(rowBytes) * (height - 1) + slotRowBytes) {
+    return false;
+  }
+  auto source = reinterpret_cast<const uint8_t*>(ring) + RingHeaderSize +
+                RingSlotSize(ring->width, ring->height) * slot;
+  if (rowBytes == slotRowBytes) {
+    memcpy(pixels, source, RingSlotSize(ring->width, ring->height));
+    return true;
+  }
+  for (int row = 0; row < ring->height; row++) {
+    memcpy(pixels + rowBytes * row, source + slotRowBytes * row, slotRowBytes);
+  }
+  return true;
+}
+
+int64_t JRenderClient::slotFrame(int slot) const {
+  std::lock_guard<std::mutex> autoLock(locker);
+  // The server writes the frame before it marks the slot as ready.
+  if (ring == nullptr || slot < 0 || slot >= ring->slotCount ||
+      ring->states[slot].load(std::memory_order_acquire) != RingSlotReady) {
+    return -1;
+  }
+  return ring->frames[slot];
+}
+
+void JRenderClient::unmapRing() {
+  if (ring != nullptr) {
+    munmap(ring, ringSize);
+    ring = nullptr;
+    ringSize = 0;
+  }
+}
+#else
+std::unique_ptr<JRenderClient> JRenderClient::Connect(const std::string&) {
+  LOGE("JRenderClient: The render server is not supported on Windows!");
+  return nullptr;
+}
+
+JRenderClient::~JRenderClient() = default;
+
+bool JRenderClient::request(const RenderRequest&, const void*, RenderReply*, std::string*) {
+  return false;
+}
+
+bool JRenderClient::handleLoadReply(const RenderReply&) {
+  return false;
+}
+
+bool JRenderClient::loadFile(const std::string&) {
+  return false;
+}
+
+bool JRenderClient::loadData(const void*, size_t) {
+  return false;
+}
+
+bool JRenderClient::setupRing(int, int, int) {
+  return false;
+}
+
+int JRenderClient::renderFrame(int64_t) {
+  return -1;
+}
+
+void JRenderClient::releaseSlot(int) {
+}
+
+bool JRenderClient::copySlot(int, uint8_t*, size_t, size_t) {
+  return false;
+}
+
+int64_t JRenderClient::slotFrame(int) const {
+  return -1;
+}
+
+void JRenderClient::unmapRing() {
+}
+#endif
+
+namespace pag {
+static jfieldID PAGRenderClient_nativeContext;
+}
+
+static JRenderClient* GetRenderClient(JNIEnv* env, jobject thiz) {
+  return reinterpret_cast<JRenderClient*>(env->GetLongField(thiz, PAGRenderClient_nativeContext));
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGRenderClient_ConnectClient(JNIEnv* env, jclass,
+                                                                     jstring socketPath) {
+  PAG4J_TRACE_EVENT("jni", "PAGRenderClient.Connect");
+  auto client = JRenderClient::Connect(SafeConvertToStdString(env, socketPath));
+  if (client == nullptr) {
+    return 0;
+  }
+  return reinterpret_cast<jlong>(client.release());
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGRenderClient_nativeRelease(JNIEnv* env, jobject thiz) {
+  delete GetRenderClient(env, thiz);
+  env->SetLongField(thiz, PAGRenderClient_nativeContext, 0);
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGRenderClient_load(JNIEnv* env, jobject thiz,
+                                                               jstring path) {
+  PAG4J_TRACE_EVENT("jni", "PAGRenderClient.load");
+  auto client = GetRenderClient(env, thiz);
+  auto filePath = SafeConvertToStdString(env, path);
+  if (client == nullptr || filePath.empty()) {
+    return JNI_FALSE;
+  }
+  return static_cast<jboolean>(client->loadFile(filePath));
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGRenderClient_loadData(JNIEnv* env, jobject thiz,
+                                                                   jbyteArray bytes) {
+  PAG4J_TRACE_EVENT("jni", "PAGRenderClient.loadData");
+  auto client = GetRenderClient(env, thiz);
+  if (client == nullptr || bytes == nullptr) {
+    return JNI_FALSE;
+  }
+  auto data = env->GetByteArrayElements(bytes, nullptr);
+  if (data == nullptr) {
+    return JNI_FALSE;
+  }
+  auto success = client->loadData(data, static_cast<size_t>(env->GetArrayLength(bytes)));
+  env->ReleaseByteArrayElements(bytes, data, JNI_ABORT);
+  return static_cast<jboolean>(success);
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGRenderClient_width(JNIEnv* env, jobject thiz) {
+  auto client = GetRenderClient(env, thiz);
+  return client != nullptr ? client->fileWidth() : 0;
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGRenderClient_height(JNIEnv* env, jobject thiz) {
+  auto client = GetRenderClient(env, thiz);
+  return client != nullptr ? client->fileHeight() : 0;
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGRenderClient_duration(JNIEnv* env, jobject thiz) {
+  auto client = GetRenderClient(env, thiz);
+  return client != nullptr ? client->duration() : 0;
+}
+
+JNIEXPORT jfloat JNICALL Java_org_libpag_PAGRenderClient_frameRate(JNIEnv* env, jobject thiz) {
+  auto client = GetRenderClient(env, thiz);
+  return client != nullptr ? client->frameRate() : 0;
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGRenderClient_numFrames(JNIEnv* env, jobject thiz) {
+  auto client = GetRenderClient(env, thiz);
+  return client != nullptr ? client->numFrames() : 0;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGRenderClient_setupRing(JNIEnv* env, jobject thiz,
+                                                                    jint width, jint height,
+                                                                    jint slotCount) {
+  PAG4J_TRACE_EVENT("jni", "PAGRenderClient.setupRing");
+  auto client = GetRenderClient(env, thiz);
+  if (client == nullptr) {
+    return JNI_FALSE;
+  }
+  return static_cast<jboolean>(client->setupRing(width, height, slotCount));
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGRenderClient_renderFrame(JNIEnv* env, jobject thiz,
+                                                                  jlong frame) {
+  PAG4J_TRACE_EVENT("jni", "PAGRenderClient.renderFrame");
+  auto client = GetRenderClient(env, thiz);
+  return client != nullptr ? client->renderFrame(frame) : -1;
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGRenderClient_releaseSlot(JNIEnv* env, jobject thiz,
+                                                                  jint slot) {
+  auto client = GetRenderClient(env, thiz);
+  if (client != nullptr) {
+    client->releaseSlot(slot);
+  }
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGRenderClient_slotFrame(JNIEnv* env, jobject thiz,
+                                                                 jint slot) {
+  auto client = GetRenderClient(env, thiz);
+  return client != nullptr ? client->slotFrame(slot) : -1;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGRenderClient_copySlotTo(JNIEnv* env, jobject thiz,
+                                                                     jint slot, jbyteArray pixels,
+                                                                     jint stride) {
+  PAG4J_TRACE_EVENT("jni", "PAGRenderClient.copySlotTo");
+  auto client = GetRenderClient(env, thiz);
+  if (client == nullptr || pixels == nullptr || stride <= 0) {
+    return JNI_FALSE;
+  }
+  auto capacity = static_cast<size_t>(env->GetArrayLength(pixels));
+  auto pixelBuffer = env->GetByteArrayElements(pixels, nullptr);
+  if (pixelBuffer == nullptr) {
+    return JNI_FALSE;
+  }
+  auto success = client->copySlot(slot, reinterpret_cast<uint8_t*>(pixelBuffer),
+                                  static_cast<size_t>(stride), capacity);
+  env->ReleaseByteArrayElements(pixels, pixelBuffer, success ? 0 : JNI_ABORT);
+  return static_cast<jboolean>(success);
+}
+}
+
+static JNINativeMethod PAGRenderClient_methods[] = {
+    {"ConnectClient", "(Ljava/lang/String;)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_ConnectClient)},
+    {"load", "(Ljava/lang/String;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_load)},
+    {"loadData", "([B)Z", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_loadData)},
+    {"width", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_width)},
+    {"height", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_height)},
+    {"duration", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_duration)},
+    {"frameRate", "()F", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_frameRate)},
+    {"numFrames", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_numFrames)},
+    {"setupRing", "(III)Z", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_setupRing)},
+    {"renderFrame", "(J)I", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_renderFrame)},
+    {"copySlotTo", "(I[BI)Z", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_copySlotTo)},
+    {"slotFrame", "(I)J", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_slotFrame)},
+    {"releaseSlot", "(I)V", reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_releaseSlot)},
+    {"nativeRelease", "()V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGRenderClient_nativeRelease)},
+};
+
+namespace pag {
+bool RegisterPAGRenderClientNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGRenderClient", PAGRenderClient_methods,
+                                     sizeof(PAGRenderClient_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGRenderClient_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
@@ -0,0 +1,124 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include "JRenderProtocol.h"
+
+/**
+ * The client side of a session with a pag4j-server process. The server renders into a shared
+ * memory ring that is mapped into this process as well, so the pixels of a rendered frame are
+ * copied once, straight from the mapping into a Java array, instead of being sent over the socket.
+ * The mapping never leaves this class, it can be unmapped at any time without leaving Java with a
+ * dangling buffer. Not supported on Windows, where Connect() always returns nullptr.
+ */
+class JRenderClient {
+ public:
+  static std::unique_ptr<JRenderClient> Connect(const std::string& socketPath);
+
+  ~JRenderClient();
+
+  /**
+   * Loads a PAG file in the server, from a path on this machine or from the bytes of the file.
+   */
+  bool loadFile(const std::string& path);
+  bool loadData(const void* data, size_t length);
+
+  /**
+   * Creates a ring of slotCount frames of the size in the server and maps it.
+   */
+  bool setupRing(int width, int height, int slotCount);
+
+  /**
+   * Renders the frame into a free slot and returns its index. Returns -1 if every slot is still
+   * held by the client or the session failed.
+   */
+  int renderFrame(int64_t frame);
+
+  /**
+   * Hands the slot back to the server for rendering.
+   */
+  void releaseSlot(int slot);
+
+  /**
+   * Copies the pixels of the slot to the buffer of capacity bytes, whose rows are rowBytes apart.
+   * Returns false if no ring is mapped, the slot does not hold a rendered frame, or the buffer is
+   * too small for the ring.
+   */
+  bool copySlot(int slot, uint8_t* pixels, size_t rowBytes, size_t capacity);
+
+  /**
+   * Returns the frame rendered into the slot, or -1 if the slot does not hold a rendered frame.
+   */
+  int64_t slotFrame(int slot) const;
+
+  int width() const {
+    return ring != nullptr ? ring->width : 0;
+  }
+
+  int height() const {
+    return ring != nullptr ? ring->height : 0;
+  }
+
+  int slotCount() const {
+    return ring != nullptr ? ring->slotCount : 0;
+  }
+
+  int fileWidth() const {
+    return _fileWidth;
+  }
+
+  int fileHeight() const {
+    return _fileHeight;
+  }
+
+  int64_t duration() const {
+    return _duration;
+  }
+
+  float frameRate() const {
+    return _frameRate;
+  }
+
+  int64_t numFrames() const {
+    return _numFrames;
+  }
+
+ private:
+  int fd = -1;
+  pag::RingHeader* ring = nullptr;
+  size_t ringSize = 0;
+  int _fileWidth = 0;
+  int _fileHeight = 0;
+  int64_t _duration = 0;
+  float _frameRate = 0;
+  int64_t _numFrames = 0;
+  mutable std::mutex locker = {};
+
+  explicit JRenderClient(int fd) : fd(fd) {
+  }
+
+  bool request(const pag::RenderRequest& request, const void* payload, pag::RenderReply* reply,
+               std::string* replyPayload);
+  bool handleLoadReply(const pag::RenderReply& reply);
+  void unmapRing();
+};
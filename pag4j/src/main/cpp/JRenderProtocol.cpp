@@ -0,0 +1,86 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JRenderProtocol.h"
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace pag {
+#ifndef _WIN32
+bool ReadFully(int fd, void* data, size_t size) {
+  auto bytes = static_cast<uint8_t*>(data);
+  while (size > 0) {
+    auto count = read(fd, bytes, size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+bool WriteFully(int fd, const void* data, size_t size) {
+  auto bytes = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    // MSG_NOSIGNAL keeps a closed peer from raising SIGPIPE, which would kill the JVM.
+#ifdef MSG_NOSIGNAL
+    auto count = send(fd, bytes, size, MSG_NOSIGNAL);
+#else
+    auto count = write(fd, bytes, size);
+#endif
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+bool ReadPayload(int fd, uint32_t payloadSize, std::string* payload) {
+  if (payloadSize > MaxPayloadSize) {
+    return false;
+  }
+  payload->resize(payloadSize);
+  return payloadSize == 0 || ReadFully(fd, &(*payload)[0], payloadSize);
+}
+#else
+bool ReadFully(int, void*, size_t) {
+  return false;
+}
+
+bool WriteFully(int, const void*, size_t) {
+  return false;
+}
+
+bool ReadPayload(int, uint32_t, std::string*) {
+  return false;
+}
+#endif
+}  // namespace pag
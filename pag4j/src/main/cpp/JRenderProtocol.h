@@ -0,0 +1,120 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pag {
+/**
+ * The protocol between PAGRenderClient and the pag4j-server executable. Both sides run on the same
+ * machine from the same build, so messages are sent as raw structs in native byte order over a
+ * Unix domain socket. Every request is answered by exactly one reply, each optionally followed by
+ * payloadSize bytes of payload.
+ */
+enum class RenderCommand : uint32_t {
+  // Payload: the path of a PAG file. Reply: values = {width, height, duration}, value = frame rate.
+  LoadFile = 1,
+  // Payload: the bytes of a PAG file. Reply: the same as LoadFile.
+  LoadData = 2,
+  // args = {width, height, slotCount}. Reply payload: the name of the shared memory object.
+  SetupRing = 3,
+  // args = {frame}, progress = the progress to render. Reply: values = {slot}.
+  RenderFrame = 4,
+  // Ends the session, there is no reply.
+  Close = 5,
+};
+
+enum class RenderStatus : int32_t {
+  OK = 0,
+  // The request was invalid or failed, such as a file that cannot be loaded.
+  Failed = 1,
+  // Every slot of the ring is still held by the client.
+  Busy = 2,
+};
+
+struct RenderRequest {
+  RenderCommand command = RenderCommand::Close;
+  uint32_t payloadSize = 0;
+  int64_t args[3] = {};
+  double progress = 0;
+};
+
+struct RenderReply {
+  RenderStatus status = RenderStatus::Failed;
+  uint32_t payloadSize = 0;
+  int64_t values[3] = {};
+  double value = 0;
+};
+
+/**
+ * The states of a slot in the shared memory ring. The server moves a slot from Free to Rendering to
+ * Ready, the client returns it to Free once it is done with the pixels.
+ */
+enum RingSlotState : uint32_t { RingSlotFree = 0, RingSlotRendering = 1, RingSlotReady = 2 };
+
+static constexpr uint32_t RingMagic = 0x4A474150;  // "PAGJ"
+static constexpr int MaxRingSlots = 16;
+// The pixels of the slots start at a page boundary behind the header.
+static constexpr size_t RingHeaderSize = 4096;
+// Paths of Unix domain sockets are limited to the size of sockaddr_un::sun_path, leaving room for
+// the suffix of the temporary name the server binds to first.
+static constexpr size_t MaxSocketPathLength = 100;
+static constexpr uint32_t MaxPayloadSize = 256 * 1024 * 1024;
+
+/**
+ * The header at the start of the shared memory object, followed by slotCount slots of
+ * height * width * 4 bytes of premultiplied RGBA pixels each.
+ */
+struct RingHeader {
+  uint32_t magic;
+  int32_t width;
+  int32_t height;
+  int32_t slotCount;
+  std::atomic<uint32_t> states[MaxRingSlots];
+  int64_t frames[MaxRingSlots];
+};
+
+static_assert(sizeof(RingHeader) <= RingHeaderSize, "The ring header must fit its page.");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "The slot states are shared between processes and must be lock free.");
+
+inline size_t RingSlotSize(int width, int height) {
+  return static_cast<size_t>(width) * height * 4;
+}
+
+inline size_t RingMappingSize(int width, int height, int slotCount) {
+  return RingHeaderSize + RingSlotSize(width, height) * slotCount;
+}
+
+/**
+ * Reads or writes exactly size bytes, retrying on partial transfers and interrupts. Returns false
+ * if the peer closed the connection or an error occurred.
+ */
+bool ReadFully(int fd, void* data, size_t size);
+bool WriteFully(int fd, const void* data, size_t size);
+
+/**
+ * Reads the payload that follows a request or reply with the payload size.
+ */
+bool ReadPayload(int fd, uint32_t payloadSize, std::string* payload);
+}  // namespace pag
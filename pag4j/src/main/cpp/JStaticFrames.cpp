@@ -0,0 +1,194 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JStaticFrames.h"
+#include <cmath>
+#include <cstdint>
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+namespace pag {
+// The analysis only needs the flush results, the size of the surface does not change them.
+static constexpr int AnalysisSurfaceSize = 16;
+
+std::shared_ptr<JStaticFrames> JStaticFrames::Analyze(std::shared_ptr<PAGFile> file) {
+  PAG4J_TRACE_EVENT("pag", "PAGStaticFrames::Analyze");
+  if (file == nullptr) {
+    return nullptr;
+  }
+  auto surface = PAGSurface::MakeOffscreen(AnalysisSurfaceSize, AnalysisSurfaceSize);
+  if (surface == nullptr) {
+    return nullptr;
+  }
+  // A copy keeps the analysis from moving the progress of the file, which may be playing. The copy
+  // has the original content, a file edited before the analysis never matches the table.
+  auto version = ContentVersion(file);
+  auto copy = file->copyOriginal();
+  auto player = std::make_shared<PAGPlayer>();
+  player->setSurface(surface);
+  player->setComposition(copy);
+  // The default frame rate limit would merge frames of files above 60 fps.
+  player->setMaxFrameRate(copy->frameRate());
+  auto frames = std::make_shared<JStaticFrames>();
+  frames->file = file;
+  // Version 0 means the tree containing the file has never been edited.
+  frames->version = version == 0 ? 0 : UINT64_MAX;
+  frames->_numFrames = CountFrames(file);
+  frames->_bits.resize(static_cast<size_t>((frames->_numFrames + 63) / 64), 0);
+  for (int64_t frame = 0; frame < frames->_numFrames; frame++) {
+    player->setProgress(FrameToProgress(frame, frames->_numFrames));
+    auto changed = player->flush();
+    if (frame > 0 && !changed) {
+      frames->_bits[frame / 64] |= uint64_t(1) << (frame % 64);
+      frames->_numDuplicates++;
+    }
+  }
+  player->setComposition(nullptr);
+  return frames;
+}
+
+bool JStaticFrames::isDuplicate(int64_t frame) const {
+  if (frame <= 0 || frame >= _numFrames) {
+    return false;
+  }
+  return (_bits[frame / 64] >> (frame % 64)) & 1;
+}
+
+bool JStaticFrames::isStaticBetween(int64_t fromFrame, int64_t toFrame) const {
+  auto first = std::min(fromFrame, toFrame);
+  auto last = std::max(fromFrame, toFrame);
+  if (first < 0 || last >= _numFrames) {
+    return false;
+  }
+  for (auto frame = first + 1; frame <= last; frame++) {
+    if (!isDuplicate(frame)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool JStaticFrames::matches(std::shared_ptr<PAGComposition> composition) const {
+  if (composition == nullptr || composition != file.lock()) {
+    return false;
+  }
+  // Any edit bumps the version of the tree, even one that keeps the frame count, such as moving a
+  // layer in time or hiding it.
+  return ContentVersion(composition) == version && CountFrames(composition) == _numFrames;
+}
+
+static jfieldID PAGStaticFrames_nativeContext;
+}  // namespace pag
+
+using namespace pag;
+
+static std::shared_ptr<JStaticFrames> GetStaticFrames(JNIEnv* env, jobject thiz) {
+  auto handle = reinterpret_cast<std::shared_ptr<JStaticFrames>*>(
+      env->GetLongField(thiz, PAGStaticFrames_nativeContext));
+  return handle != nullptr ? *handle : nullptr;
+}
+
+namespace pag {
+std::shared_ptr<JStaticFrames> ToStaticFramesNativeObject(JNIEnv* env, jobject staticFrames) {
+  if (staticFrames == nullptr) {
+    return nullptr;
+  }
+  return GetStaticFrames(env, staticFrames);
+}
+}  // namespace pag
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGStaticFrames_AnalyzeFile(JNIEnv* env, jclass,
+                                                                   jobject pagFile) {
+  PAG4J_TRACE_EVENT("jni", "PAGStaticFrames.Analyze");
+  auto composition = ToPAGCompositionNativeObject(env, pagFile);
+  if (composition == nullptr || !composition->isPAGFile()) {
+    return 0;
+  }
+  auto frames = JStaticFrames::Analyze(std::static_pointer_cast<PAGFile>(composition));
+  if (frames == nullptr) {
+    LOGE("PAGStaticFrames.Analyze(): Failed to analyze the PAGFile!");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(new std::shared_ptr<JStaticFrames>(frames));
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGStaticFrames_nativeRelease(JNIEnv* env, jobject thiz) {
+  delete reinterpret_cast<std::shared_ptr<JStaticFrames>*>(
+      env->GetLongField(thiz, PAGStaticFrames_nativeContext));
+  env->SetLongField(thiz, PAGStaticFrames_nativeContext, 0);
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGStaticFrames_numFrames(JNIEnv* env, jobject thiz) {
+  auto frames = GetStaticFrames(env, thiz);
+  return frames != nullptr ? frames->numFrames() : 0;
+}
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGStaticFrames_numDuplicates(JNIEnv* env, jobject thiz) {
+  auto frames = GetStaticFrames(env, thiz);
+  return frames != nullptr ? frames->numDuplicates() : 0;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGStaticFrames_isDuplicate(JNIEnv* env, jobject thiz,
+                                                                      jlong frame) {
+  auto frames = GetStaticFrames(env, thiz);
+  return static_cast<jboolean>(frames != nullptr && frames->isDuplicate(frame));
+}
+
+JNIEXPORT jlongArray JNICALL Java_org_libpag_PAGStaticFrames_duplicateBits(JNIEnv* env,
+                                                                          jobject thiz) {
+  auto frames = GetStaticFrames(env, thiz);
+  if (frames == nullptr) {
+    return env->NewLongArray(0);
+  }
+  auto& bits = frames->bits();
+  auto array = env->NewLongArray(static_cast<jsize>(bits.size()));
+  if (array != nullptr && !bits.empty()) {
+    env->SetLongArrayRegion(array, 0, static_cast<jsize>(bits.size()),
+                            reinterpret_cast<const jlong*>(bits.data()));
+  }
+  return array;
+}
+}
+
+static JNINativeMethod PAGStaticFrames_methods[] = {
+    {"AnalyzeFile", "(Lorg/libpag/PAGFile;)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGStaticFrames_AnalyzeFile)},
+    {"numFrames", "()J", reinterpret_cast<void*>(Java_org_libpag_PAGStaticFrames_numFrames)},
+    {"numDuplicates", "()J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGStaticFrames_numDuplicates)},
+    {"isDuplicate", "(J)Z", reinterpret_cast<void*>(Java_org_libpag_PAGStaticFrames_isDuplicate)},
+    {"duplicateBits", "()[J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGStaticFrames_duplicateBits)},
+    {"nativeRelease", "()V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGStaticFrames_nativeRelease)},
+};
+
+namespace pag {
+bool RegisterPAGStaticFramesNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGStaticFrames", PAGStaticFrames_methods,
+                                     sizeof(PAGStaticFrames_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGStaticFrames_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  return true;
+}
+}  // namespace pag
@@ -0,0 +1,86 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <jni.h>
+#include <vector>
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * A per-frame table of the frames that render exactly the same content as the frame before them,
+ * produced by replaying a PAGFile once. Frame N is marked as a duplicate if flushing a player at
+ * frame N right after frame N-1 reports no change, so the table follows libpag's own change
+ * detection, including layers, masks, effects and video sequences.
+ */
+class JStaticFrames {
+ public:
+  /**
+   * Replays every frame of the original content of the file on a small offscreen surface. Returns
+   * nullptr if the file is nullptr or no offscreen surface can be created.
+   */
+  static std::shared_ptr<JStaticFrames> Analyze(std::shared_ptr<PAGFile> file);
+
+  int64_t numFrames() const {
+    return _numFrames;
+  }
+
+  int64_t numDuplicates() const {
+    return _numDuplicates;
+  }
+
+  /**
+   * Returns true if the frame renders the same content as the frame before it. The first frame is
+   * never a duplicate.
+   */
+  bool isDuplicate(int64_t frame) const;
+
+  /**
+   * Returns true if every frame between the two frames, inclusive, renders the same content.
+   */
+  bool isStaticBetween(int64_t fromFrame, int64_t toFrame) const;
+
+  /**
+   * Returns the bitmap in which bit (N % 64) of word (N / 64) is set if frame N is a duplicate.
+   */
+  const std::vector<uint64_t>& bits() const {
+    return _bits;
+  }
+
+  /**
+   * Returns true if the composition is the analyzed file and neither the file nor any of its
+   * layers has been edited through the bindings since the analysis. Once false, the table stays
+   * stale for good.
+   */
+  bool matches(std::shared_ptr<PAGComposition> composition) const;
+
+ private:
+  std::weak_ptr<PAGFile> file;
+  uint64_t version = 0;
+  int64_t _numFrames = 0;
+  int64_t _numDuplicates = 0;
+  std::vector<uint64_t> _bits;
+};
+
+/**
+ * Returns the table of a Java PAGStaticFrames object, or nullptr if it is null or released.
+ */
+std::shared_ptr<JStaticFrames> ToStaticFramesNativeObject(JNIEnv* env, jobject staticFrames);
+}  // namespace pag
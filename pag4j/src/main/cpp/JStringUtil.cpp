@@ -17,43 +17,205 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "JStringUtil.h"
+#include <cstdint>
 #include <cstring>
+#include <vector>
 
 namespace pag {
+// Strings up to this many UTF-16 code units are transcoded without allocating on the heap.
+static constexpr size_t StackBufferLength = 256;
+static constexpr uint64_t HighBitsMask = 0x8080808080808080ULL;
+static constexpr uint64_t LowBitsMask = 0x0101010101010101ULL;
+static constexpr uint64_t NonASCIICharsMask = 0xFF80FF80FF80FF80ULL;
+static constexpr jchar ReplacementChar = 0xFFFD;
+
+/**
+ * Returns true if every byte is in 0x01-0x7F. Such text is valid modified UTF-8 and can be passed
+ * to NewStringUTF() as it is. The bytes are checked eight at a time in a 64-bit word.
+ */
+static bool IsPlainASCII(const char* text, size_t length) {
+  size_t index = 0;
+  for (; index + sizeof(uint64_t) <= length; index += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, text + index, sizeof(word));
+    // The second term flags the zero bytes, whose high bit is set after subtracting one.
+    if (((word | ((word - LowBitsMask) & ~word)) & HighBitsMask) != 0) {
+      return false;
+    }
+  }
+  for (; index < length; index++) {
+    auto c = static_cast<uint8_t>(text[index]);
+    if (c == 0 || c >= 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns true if every UTF-16 code unit is below 0x80, checking four of them at a time.
+ */
+static bool IsASCII(const jchar* chars, size_t length) {
+  size_t index = 0;
+  for (; index + 4 <= length; index += 4) {
+    uint64_t word = 0;
+    memcpy(&word, chars + index, sizeof(word));
+    if ((word & NonASCIICharsMask) != 0) {
+      return false;
+    }
+  }
+  for (; index < length; index++) {
+    if (chars[index] >= 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool IsContinuation(uint8_t c) {
+  return (c & 0xC0) == 0x80;
+}
+
+/**
+ * Decodes UTF-8 to UTF-16 and returns the number of code units written, which is at most the
+ * number of bytes. Like the String(byte[], "UTF-8") constructor, every malformed sequence is
+ * replaced by U+FFFD.
+ */
+static size_t DecodeUTF8(const uint8_t* text, size_t length, jchar* output) {
+  size_t count = 0;
+  size_t index = 0;
+  while (index < length) {
+    auto c = text[index];
+    if (c < 0x80) {
+      output[count++] = c;
+      index++;
+      continue;
+    }
+    size_t extraBytes = 0;
+    uint32_t codePoint = 0;
+    // The valid range of the second byte, which rules out overlong forms, surrogates and code
+    // points above U+10FFFF.
+    uint8_t lower = 0x80;
+    uint8_t upper = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF) {
+      extraBytes = 1;
+      codePoint = c & 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+      extraBytes = 2;
+      codePoint = c & 0x0F;
+      lower = c == 0xE0 ? 0xA0 : 0x80;
+      upper = c == 0xED ? 0x9F : 0xBF;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+      extraBytes = 3;
+      codePoint = c & 0x07;
+      lower = c == 0xF0 ? 0x90 : 0x80;
+      upper = c == 0xF4 ? 0x8F : 0xBF;
+    } else {
+      output[count++] = ReplacementChar;
+      index++;
+      continue;
+    }
+    index++;
+    size_t consumed = 0;
+    for (; consumed < extraBytes && index < length; consumed++, index++) {
+      auto next = text[index];
+      if (!IsContinuation(next) || (consumed == 0 && (next < lower || next > upper))) {
+        break;
+      }
+      codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+    if (consumed < extraBytes) {
+      // The bytes read so far form one malformed sequence, the next one starts at the byte that
+      // broke it.
+      output[count++] = ReplacementChar;
+    } else if (codePoint >= 0x10000) {
+      codePoint -= 0x10000;
+      output[count++] = static_cast<jchar>(0xD800 + (codePoint >> 10));
+      output[count++] = static_cast<jchar>(0xDC00 + (codePoint & 0x3FF));
+    } else {
+      output[count++] = static_cast<jchar>(codePoint);
+    }
+  }
+  return count;
+}
+
+/**
+ * Encodes UTF-16 as UTF-8. Like String.getBytes("UTF-8"), unpaired surrogates become '?'.
+ */
+static void EncodeUTF8(const jchar* chars, size_t length, std::string* output) {
+  output->reserve(output->size() + length * 3);
+  for (size_t index = 0; index < length; index++) {
+    uint32_t c = chars[index];
+    if (c < 0x80) {
+      output->push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+      output->push_back(static_cast<char>(0xC0 | (c >> 6)));
+      output->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c >= 0xD800 && c <= 0xDFFF) {
+      if (c <= 0xDBFF && index + 1 < length && chars[index + 1] >= 0xDC00 &&
+          chars[index + 1] <= 0xDFFF) {
+        auto codePoint = 0x10000 + ((c - 0xD800) << 10) + (chars[index + 1] - 0xDC00);
+        index++;
+        output->push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        output->push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        output->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        output->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+      } else {
+        output->push_back('?');
+      }
+    } else {
+      output->push_back(static_cast<char>(0xE0 | (c >> 12)));
+      output->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      output->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+  }
+}
+
 /**
- * There is a known bug in env->NewStringUTF which will lead to crash in some devices.
- * So we use this method instead.
+ * There is a known bug in env->NewStringUTF which will lead to crash in some devices when the text
+ * is not valid modified UTF-8, such as 4-byte sequences or malformed bytes. So it is only used for
+ * plain ASCII text, everything else is decoded here and passed to NewString() as UTF-16.
  */
 jstring SafeConvertToJString(JNIEnv* env, const std::string& text) {
-  jclass StringClass = env->FindClass("java/lang/String");
-  jmethodID StringConstructID = env->GetMethodID(StringClass, "<init>", "([BLjava/lang/String;)V");
-  auto array = env->NewByteArray(text.size());
-  env->SetByteArrayRegion(array, 0, text.size(), reinterpret_cast<const jbyte*>(text.data()));
-  auto stringUTF = env->NewStringUTF("UTF-8");
-  auto result = (jstring)env->NewObject(StringClass, StringConstructID, array, stringUTF);
-  env->DeleteLocalRef(array);
-  env->DeleteLocalRef(stringUTF);
-  return result;
+  if (IsPlainASCII(text.data(), text.size())) {
+    return env->NewStringUTF(text.c_str());
+  }
+  jchar stackBuffer[StackBufferLength];
+  std::vector<jchar> heapBuffer = {};
+  auto chars = stackBuffer;
+  if (text.size() > StackBufferLength) {
+    heapBuffer.resize(text.size());
+    chars = heapBuffer.data();
+  }
+  auto length = DecodeUTF8(reinterpret_cast<const uint8_t*>(text.data()), text.size(), chars);
+  return env->NewString(chars, static_cast<jsize>(length));
 }
 
 std::string SafeConvertToStdString(JNIEnv* env, jstring jText) {
   if (jText == nullptr) {
     return "";
   }
-  std::string result;
-  jclass StringClass = env->FindClass("java/lang/String");
-  jmethodID GetBytesID = env->GetMethodID(StringClass, "getBytes", "(Ljava/lang/String;)[B");
-  auto encoding = env->NewStringUTF("utf-8");
-  auto jBytes = (jbyteArray)env->CallObjectMethod(jText, GetBytesID, encoding);
-  env->DeleteLocalRef(encoding);
-  auto textLength = env->GetArrayLength(jBytes);
-  if (textLength > 0) {
-    char* bytes = new char[textLength];
-    env->GetByteArrayRegion(jBytes, 0, textLength, (jbyte*)bytes);
-    result = std::string(bytes, (unsigned)textLength);
-    delete[] bytes;
-  }
-  env->DeleteLocalRef(jBytes);
+  auto length = static_cast<size_t>(env->GetStringLength(jText));
+  if (length == 0) {
+    return "";
+  }
+  jchar stackBuffer[StackBufferLength];
+  std::vector<jchar> heapBuffer = {};
+  auto chars = stackBuffer;
+  if (length > StackBufferLength) {
+    heapBuffer.resize(length);
+    chars = heapBuffer.data();
+  }
+  env->GetStringRegion(jText, 0, static_cast<jsize>(length), chars);
+  std::string result = {};
+  if (IsASCII(chars, length)) {
+    result.resize(length);
+    for (size_t i = 0; i < length; i++) {
+      result[i] = static_cast<char>(chars[i]);
+    }
+    return result;
+  }
+  EncodeUTF8(chars, length, &result);
   return result;
 }
-}  // namespace pag
\ No newline at end of file
+}  // namespace pag
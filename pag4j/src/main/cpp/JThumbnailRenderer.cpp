@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JThumbnailRenderer.h"
+#include <algorithm>
+#include "JTrace.h"
+
+namespace pag {
+struct ThumbnailContext {
+  std::shared_ptr<PAGSurface> surface = nullptr;
+  std::shared_ptr<PAGPlayer> player = nullptr;
+};
+
+static ThumbnailContext* GetThumbnailContext(int width, int height) {
+  static thread_local ThumbnailContext context = {};
+  if (context.surface == nullptr || context.surface->width() != width ||
+      context.surface->height() != height) {
+    context.player = nullptr;
+    context.surface = PAGSurface::MakeOffscreen(width, height);
+    if (context.surface == nullptr) {
+      return nullptr;
+    }
+    context.player = std::make_shared<PAGPlayer>();
+    // A thumbnail is rendered once, so the layer caches would only cost memory and time.
+    context.player->setCacheEnabled(false);
+    context.player->setSurface(context.surface);
+  }
+  return &context;
+}
+
+bool JThumbnailRenderer::Render(std::shared_ptr<PAGComposition> composition, double progress,
+                                int width, int height, void* pixels, size_t rowBytes) {
+  PAG4J_TRACE_EVENT("pag", "JThumbnailRenderer::Render");
+  if (composition == nullptr || width <= 0 || height <= 0 || pixels == nullptr ||
+      composition->width() <= 0 || composition->height() <= 0) {
+    return false;
+  }
+  auto context = GetThumbnailContext(width, height);
+  if (context == nullptr) {
+    return false;
+  }
+  auto player = context->player;
+  // The letterbox matrix of the small surface already makes libpag draw at the thumbnail size and
+  // pick the smallest video or bitmap sequence that covers it, the cache scale keeps the image
+  // caches at that size as well.
+  auto scale = std::min(static_cast<float>(width) / static_cast<float>(composition->width()),
+                        static_cast<float>(height) / static_cast<float>(composition->height()));
+  player->setCacheScale(std::min(scale, 1.0f));
+  player->setComposition(composition);
+  player->setProgress(progress);
+  player->flush();
+  auto success = context->surface->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied,
+                                              pixels, rowBytes);
+  player->setComposition(nullptr);
+  // Catalog jobs rarely render the same file twice, so the decoded assets are dropped right away.
+  context->surface->freeCache();
+  return success;
+}
+
+bool JThumbnailRenderer::RenderToArray(JNIEnv* env, std::shared_ptr<PAGComposition> composition,
+                                       double progress, int width, int height, jbyteArray pixels,
+                                       int stride) {
+  // Computed in 64 bits, a large width, height or stride would otherwise wrap and pass the check.
+  auto rowBytes = static_cast<jlong>(width) * 4;
+  if (pixels == nullptr || width <= 0 || height <= 0 || stride < rowBytes ||
+      env->GetArrayLength(pixels) < static_cast<jlong>(stride) * (height - 1) + rowBytes) {
+    return false;
+  }
+  auto pixelBuffer = env->GetByteArrayElements(pixels, nullptr);
+  if (pixelBuffer == nullptr) {
+    return false;
+  }
+  auto success = Render(composition, progress, width, height, pixelBuffer,
+                        static_cast<size_t>(stride));
+  env->ReleaseByteArrayElements(pixels, pixelBuffer, 0);
+  return success;
+}
+}  // namespace pag
@@ -0,0 +1,47 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <jni.h>
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * Renders single frames of compositions at thumbnail sizes. Each thread keeps one offscreen surface
+ * and player for the last requested size, so generating many thumbnails of the same size reuses
+ * the graphics context instead of creating one per image.
+ */
+class JThumbnailRenderer {
+ public:
+  /**
+   * Renders the composition at the progress into a width x height letterboxed frame and copies its
+   * premultiplied RGBA pixels to the destination. The composition is removed from its previous
+   * player. Returns false if the frame could not be rendered or read back.
+   */
+  static bool Render(std::shared_ptr<PAGComposition> composition, double progress, int width,
+                     int height, void* pixels, size_t rowBytes);
+
+  /**
+   * Renders into a Java byte array with the specified stride, after checking that it is large
+   * enough.
+   */
+  static bool RenderToArray(JNIEnv* env, std::shared_ptr<PAGComposition> composition,
+                            double progress, int width, int height, jbyteArray pixels, int stride);
+};
+}  // namespace pag
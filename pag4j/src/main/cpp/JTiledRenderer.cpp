@@ -0,0 +1,225 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JTiledRenderer.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "JNIHelper.h"
+#include "JTrace.h"
+
+namespace pag {
+std::unique_ptr<JTiledRenderer> JTiledRenderer::Make(int tileWidth, int tileHeight) {
+  if (tileWidth <= 0 || tileHeight <= 0) {
+    return nullptr;
+  }
+  auto surface = PAGSurface::MakeOffscreen(tileWidth, tileHeight);
+  if (surface == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<JTiledRenderer> renderer(new JTiledRenderer());
+  renderer->_tileWidth = tileWidth;
+  renderer->_tileHeight = tileHeight;
+  renderer->surface = surface;
+  renderer->player = std::make_shared<PAGPlayer>();
+  // Layer caches are rasterized at the full output scale, which is exactly the memory tiling
+  // avoids. Every tile draws the layers it covers directly instead.
+  renderer->player->setCacheEnabled(false);
+  renderer->player->setSurface(surface);
+  renderer->tile.resize(static_cast<size_t>(tileWidth) * tileHeight * 4);
+  return renderer;
+}
+
+// Mirrors the placement of PAGPlayer for the scale modes, which otherwise only applies to the
+// size of the surface.
+static Matrix MakeScaleModeMatrix(int scaleMode, float contentWidth, float contentHeight,
+                                  int width, int height) {
+  auto scaleX = static_cast<float>(width) / contentWidth;
+  auto scaleY = static_cast<float>(height) / contentHeight;
+  switch (scaleMode) {
+    case PAGScaleMode::Stretch:
+      return Matrix::MakeScale(scaleX, scaleY);
+    case PAGScaleMode::LetterBox:
+    case PAGScaleMode::Zoom: {
+      auto scale = scaleMode == PAGScaleMode::LetterBox ? std::min(scaleX, scaleY)
+                                                        : std::max(scaleX, scaleY);
+      auto matrix = Matrix::MakeScale(scale, scale);
+      matrix.postTranslate((width - contentWidth * scale) * 0.5f,
+                           (height - contentHeight * scale) * 0.5f);
+      return matrix;
+    }
+    default:
+      return Matrix::I();
+  }
+}
+
+bool JTiledRenderer::render(std::shared_ptr<PAGComposition> composition, double progress,
+                            int width, int height, int scaleMode, const BandCallback& callback) {
+  PAG4J_TRACE_EVENT("pag", "JTiledRenderer::render");
+  if (composition == nullptr || width <= 0 || height <= 0 || composition->width() <= 0 ||
+      composition->height() <= 0 || !callback) {
+    return false;
+  }
+  auto rowBytes = static_cast<size_t>(width) * 4;
+  // A band is handed to Java as one direct ByteBuffer, whose capacity is limited to an int.
+  if (rowBytes * _tileHeight > static_cast<size_t>(INT_MAX)) {
+    return false;
+  }
+  band.resize(rowBytes * _tileHeight);
+  auto frameMatrix = MakeScaleModeMatrix(scaleMode, static_cast<float>(composition->width()),
+                                         static_cast<float>(composition->height()), width, height);
+  auto tileRowBytes = static_cast<size_t>(_tileWidth) * 4;
+  player->setComposition(composition);
+  player->setProgress(progress);
+  bool success = true;
+  for (int top = 0; success && top < height; top += _tileHeight) {
+    auto rows = std::min(_tileHeight, height - top);
+    for (int left = 0; success && left < width; left += _tileWidth) {
+      auto columns = std::min(_tileWidth, width - left);
+      auto matrix = frameMatrix;
+      matrix.postTranslate(static_cast<float>(-left), static_cast<float>(-top));
+      player->setMatrix(matrix);
+      {
+        PAG4J_TRACE_EVENT("pag", "PAGPlayer::flush");
+        player->flush();
+      }
+      auto destination = band.data() + static_cast<size_t>(left) * 4;
+      if (columns == _tileWidth && rows == _tileHeight) {
+        // Full tiles are read back straight into their place in the band.
+        success = surface->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied, destination,
+                                      rowBytes);
+        continue;
+      }
+      success = surface->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied, tile.data(),
+                                    tileRowBytes);
+      for (int row = 0; success && row < rows; row++) {
+        memcpy(destination + row * rowBytes, tile.data() + row * tileRowBytes,
+               static_cast<size_t>(columns) * 4);
+      }
+    }
+    if (success) {
+      PAG4J_TRACE_EVENT("jni", "PAGTiledRenderer.onBand");
+      success = callback(band.data(), top, rows);
+    }
+  }
+  player->setComposition(nullptr);
+  surface->freeCache();
+  return success;
+}
+
+static jfieldID PAGTiledRenderer_nativeContext;
+static jmethodID BandListener_onBand;
+}  // namespace pag
+
+using namespace pag;
+
+static JTiledRenderer* GetTiledRenderer(JNIEnv* env, jobject thiz) {
+  return reinterpret_cast<JTiledRenderer*>(env->GetLongField(thiz, PAGTiledRenderer_nativeContext));
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_org_libpag_PAGTiledRenderer_SetupRenderer(JNIEnv*, jclass,
+                                                                       jint tileWidth,
+                                                                       jint tileHeight) {
+  PAG4J_TRACE_EVENT("jni", "PAGTiledRenderer.SetupRenderer");
+  auto renderer = JTiledRenderer::Make(tileWidth, tileHeight);
+  if (renderer == nullptr) {
+    LOGE("PAGTiledRenderer.SetupRenderer(): Failed to create the tile surface!");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(renderer.release());
+}
+
+JNIEXPORT void JNICALL Java_org_libpag_PAGTiledRenderer_nativeRelease(JNIEnv* env, jobject thiz) {
+  delete GetTiledRenderer(env, thiz);
+  env->SetLongField(thiz, PAGTiledRenderer_nativeContext, 0);
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGTiledRenderer_tileWidth(JNIEnv* env, jobject thiz) {
+  auto renderer = GetTiledRenderer(env, thiz);
+  return renderer != nullptr ? renderer->tileWidth() : 0;
+}
+
+JNIEXPORT jint JNICALL Java_org_libpag_PAGTiledRenderer_tileHeight(JNIEnv* env, jobject thiz) {
+  auto renderer = GetTiledRenderer(env, thiz);
+  return renderer != nullptr ? renderer->tileHeight() : 0;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libpag_PAGTiledRenderer_nativeRender(
+    JNIEnv* env, jobject thiz, jobject composition, jdouble progress, jint width, jint height,
+    jint scaleMode, jobject listener) {
+  PAG4J_TRACE_EVENT("jni", "PAGTiledRenderer.render");
+  auto renderer = GetTiledRenderer(env, thiz);
+  auto pagComposition = ToPAGCompositionNativeObject(env, composition);
+  if (renderer == nullptr || pagComposition == nullptr || listener == nullptr) {
+    return JNI_FALSE;
+  }
+  auto rowBytes = static_cast<jint>(width) * 4;
+  auto success = renderer->render(
+      pagComposition, progress, width, height, scaleMode,
+      [&](const uint8_t* pixels, int top, int rows) {
+        auto buffer = env->NewDirectByteBuffer(const_cast<uint8_t*>(pixels),
+                                               static_cast<jlong>(rowBytes) * rows);
+        if (buffer == nullptr) {
+          env->ExceptionClear();
+          return false;
+        }
+        auto result = env->CallBooleanMethod(listener, BandListener_onBand, buffer, top, rows,
+                                             rowBytes);
+        env->DeleteLocalRef(buffer);
+        if (env->ExceptionCheck()) {
+          // The exception is rethrown to the caller of render() once native code returns.
+          return false;
+        }
+        return result == JNI_TRUE;
+      });
+  return static_cast<jboolean>(success);
+}
+}
+
+static JNINativeMethod PAGTiledRenderer_methods[] = {
+    {"SetupRenderer", "(II)J",
+     reinterpret_cast<void*>(Java_org_libpag_PAGTiledRenderer_SetupRenderer)},
+    {"tileWidth", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGTiledRenderer_tileWidth)},
+    {"tileHeight", "()I", reinterpret_cast<void*>(Java_org_libpag_PAGTiledRenderer_tileHeight)},
+    {"nativeRender",
+     "(Lorg/libpag/PAGComposition;DIIILorg/libpag/PAGTiledRenderer$BandListener;)Z",
+     reinterpret_cast<void*>(Java_org_libpag_PAGTiledRenderer_nativeRender)},
+    {"nativeRelease", "()V",
+     reinterpret_cast<void*>(Java_org_libpag_PAGTiledRenderer_nativeRelease)},
+};
+
+namespace pag {
+bool RegisterPAGTiledRendererNatives(JNIEnv* env) {
+  auto clazz = RegisterNativeMethods(env, "org/libpag/PAGTiledRenderer", PAGTiledRenderer_methods,
+                                     sizeof(PAGTiledRenderer_methods) / sizeof(JNINativeMethod));
+  if (clazz == nullptr) {
+    return false;
+  }
+  PAGTiledRenderer_nativeContext = env->GetFieldID(clazz, "nativeContext", "J");
+  auto listenerClass = env->FindClass("org/libpag/PAGTiledRenderer$BandListener");
+  if (listenerClass == nullptr) {
+    env->ExceptionClear();
+    return false;
+  }
+  BandListener_onBand = env->GetMethodID(listenerClass, "onBand", "(Ljava/nio/ByteBuffer;III)Z");
+  return BandListener_onBand != nullptr;
+}
+}  // namespace pag
@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "pag/pag.h"
+
+namespace pag {
+/**
+ * Renders frames far larger than the maximum texture size of the backend by rendering the
+ * composition tile by tile into one small offscreen surface, moving the player matrix for every
+ * tile. The tiles of one row are assembled into a band of full output width, which is passed to
+ * the callback before the next row is rendered, so the memory needed is one band rather than the
+ * whole frame.
+ */
+class JTiledRenderer {
+ public:
+  /**
+   * Receives the premultiplied RGBA pixels of rows [top, top + rows) of the output with a stride
+   * of width * 4 bytes. The pixels are only valid during the call. Returns false to abort.
+   */
+  using BandCallback = std::function<bool(const uint8_t* pixels, int top, int rows)>;
+
+  static std::unique_ptr<JTiledRenderer> Make(int tileWidth, int tileHeight);
+
+  int tileWidth() const {
+    return _tileWidth;
+  }
+
+  int tileHeight() const {
+    return _tileHeight;
+  }
+
+  /**
+   * Renders the composition at the progress into a width x height frame, placed by the scale mode
+   * like PAGPlayer does. The composition is removed from its previous player. Returns false if a
+   * tile failed to render or the callback aborted.
+   */
+  bool render(std::shared_ptr<PAGComposition> composition, double progress, int width, int height,
+              int scaleMode, const BandCallback& callback);
+
+ private:
+  int _tileWidth = 0;
+  int _tileHeight = 0;
+  std::shared_ptr<PAGSurface> surface = nullptr;
+  std::shared_ptr<PAGPlayer> player = nullptr;
+  std::vector<uint8_t> band = {};
+  std::vector<uint8_t> tile = {};
+};
+}  // namespace pag
@@ -0,0 +1,154 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "JTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace pag {
+struct TraceEvent {
+  const char* category = nullptr;
+  const char* name = nullptr;
+  int64_t startTime = 0;
+  int64_t duration = 0;
+  int threadID = 0;
+};
+
+std::atomic<bool> JTrace::enabled = {false};
+
+static std::mutex traceLocker = {};
+static std::vector<TraceEvent> traceEvents = {};
+static size_t nextEvent = 0;
+static bool bufferWrapped = false;
+static std::unordered_map<int, std::string> threadNames = {};
+static std::atomic<int> threadCount = {0};
+
+static int CurrentThreadID() {
+  static thread_local int threadID = ++threadCount;
+  return threadID;
+}
+
+int64_t JTrace::Now() {
+  static const auto origin = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              origin)
+      .count();
+}
+
+void JTrace::Start(int bufferSize) {
+  std::lock_guard<std::mutex> autoLock(traceLocker);
+  traceEvents.assign(static_cast<size_t>(std::max(bufferSize, 1)), {});
+  nextEvent = 0;
+  bufferWrapped = false;
+  enabled = true;
+}
+
+void JTrace::Stop() {
+  std::lock_guard<std::mutex> autoLock(traceLocker);
+  enabled = false;
+}
+
+void JTrace::SetThreadName(const std::string& name) {
+  auto threadID = CurrentThreadID();
+  std::lock_guard<std::mutex> autoLock(traceLocker);
+  threadNames[threadID] = name;
+}
+
+void JTrace::AddEvent(const char* category, const char* name, int64_t startTime,
+                      int64_t endTime) {
+  auto threadID = CurrentThreadID();
+  std::lock_guard<std::mutex> autoLock(traceLocker);
+  // The scope may have begun before tracing was stopped or restarted with another buffer.
+  if (!enabled || traceEvents.empty()) {
+    return;
+  }
+  traceEvents[nextEvent] = {category, name, startTime, endTime - startTime, threadID};
+  nextEvent++;
+  if (nextEvent == traceEvents.size()) {
+    nextEvent = 0;
+    bufferWrapped = true;
+  }
+}
+
+static void AppendEscaped(std::string* json, const std::string& text) {
+  for (auto c : text) {
+    if (c == '"' || c == '\\') {
+      json->push_back('\\');
+      json->push_back(c);
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      json->push_back(c);
+    }
+  }
+}
+
+static void AppendMicros(std::string* json, int64_t nanoseconds) {
+  char text[32];
+  snprintf(text, sizeof(text), "%lld.%03lld", static_cast<long long>(nanoseconds / 1000),
+           static_cast<long long>(nanoseconds % 1000));
+  json->append(text);
+}
+
+std::string JTrace::ToJSON() {
+  std::lock_guard<std::mutex> autoLock(traceLocker);
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (auto& item : threadNames) {
+    json.append(first ? "" : ",");
+    first = false;
+    json.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+    json.append(std::to_string(item.first));
+    json.append(",\"args\":{\"name\":\"");
+    AppendEscaped(&json, item.second);
+    json.append("\"}}");
+  }
+  auto count = bufferWrapped ? traceEvents.size() : nextEvent;
+  auto start = bufferWrapped ? nextEvent : 0;
+  for (size_t i = 0; i < count; i++) {
+    auto& event = traceEvents[(start + i) % traceEvents.size()];
+    json.append(first ? "" : ",");
+    first = false;
+    json.append("{\"name\":\"");
+    AppendEscaped(&json, event.name);
+    json.append("\",\"cat\":\"");
+    AppendEscaped(&json, event.category);
+    json.append("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+    json.append(std::to_string(event.threadID));
+    json.append(",\"ts\":");
+    AppendMicros(&json, event.startTime);
+    json.append(",\"dur\":");
+    AppendMicros(&json, event.duration);
+    json.append("}");
+  }
+  json.append("]}");
+  return json;
+}
+
+bool JTrace::WriteToFile(const std::string& path) {
+  auto json = ToJSON();
+  auto file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  auto success = fwrite(json.data(), 1, json.size(), file) == json.size();
+  return fclose(file) == 0 && success;
+}
+}  // namespace pag
@@ -0,0 +1,112 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace pag {
+/**
+ * Records complete trace events into an in-memory ring buffer and exports them as Chrome
+ * trace-event JSON, which can be opened in chrome://tracing or ui.perfetto.dev. Each native thread
+ * gets its own timeline. Recording is disabled by default, and a disabled trace point only costs
+ * one relaxed atomic load.
+ */
+class JTrace {
+ public:
+  static bool IsEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Clears the buffer and starts recording. Once bufferSize events have been recorded, the oldest
+   * ones are overwritten.
+   */
+  static void Start(int bufferSize);
+
+  /**
+   * Stops recording. The recorded events are kept until the next Start() call.
+   */
+  static void Stop();
+
+  /**
+   * Returns the recorded events as a Chrome trace-event JSON object.
+   */
+  static std::string ToJSON();
+
+  static bool WriteToFile(const std::string& path);
+
+  /**
+   * Names the timeline of the calling thread in the exported trace.
+   */
+  static void SetThreadName(const std::string& name);
+
+  /**
+   * Returns the current time of the trace clock in nanoseconds.
+   */
+  static int64_t Now();
+
+  /**
+   * Records an event of the calling thread. The category and name must be string literals, since
+   * only the pointers are stored.
+   */
+  static void AddEvent(const char* category, const char* name, int64_t startTime,
+                       int64_t endTime);
+
+ private:
+  static std::atomic<bool> enabled;
+};
+
+/**
+ * Records the lifetime of the scope as one trace event if tracing was enabled when it began.
+ */
+class TraceScope {
+ public:
+  TraceScope(const char* category, const char* name) : category(category), name(name) {
+    if (JTrace::IsEnabled()) {
+      startTime = JTrace::Now();
+    }
+  }
+
+  ~TraceScope() {
+    if (startTime >= 0) {
+      JTrace::AddEvent(category, name, startTime, JTrace::Now());
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* category = nullptr;
+  const char* name = nullptr;
+  int64_t startTime = -1;
+};
+}  // namespace pag
+
+#define PAG4J_TRACE_CONCAT_IMPL(a, b) a##b
+#define PAG4J_TRACE_CONCAT(a, b) PAG4J_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * Traces the rest of the enclosing scope. Bindings use the "jni" category for the time spent in a
+ * native method, and "pag" for the libpag calls inside it.
+ */
+#define PAG4J_TRACE_EVENT(category, name) \
+  pag::TraceScope PAG4J_TRACE_CONCAT(traceScope, __LINE__)(category, name)
@@ -0,0 +1,283 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+// pag4j-server hosts PAGPlayers in a separate process for PAGRenderClient. Usage:
+//
+//     pag4j-server [--watch-stdin] <socket path>
+//
+// Each connection to the socket is an independent session with its own player and offscreen
+// surface, served by its own thread. Rendered frames are read back directly into a POSIX shared
+// memory ring that the client maps, so the pixels never pass through the socket. With
+// --watch-stdin the server exits once its standard input is closed, which happens when the
+// process that started it dies.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "JRenderProtocol.h"
+#include "pag/pag.h"
+
+using namespace pag;
+
+static std::atomic<int> sessionCount = {0};
+
+class RenderSession {
+ public:
+  explicit RenderSession(int fd) : fd(fd) {
+  }
+
+  ~RenderSession() {
+    releaseRing();
+    close(fd);
+  }
+
+  void run() {
+    while (true) {
+      RenderRequest request = {};
+      std::string payload = {};
+      if (!ReadFully(fd, &request, sizeof(request)) ||
+          !ReadPayload(fd, request.payloadSize, &payload)) {
+        return;
+      }
+      if (request.command == RenderCommand::Close) {
+        return;
+      }
+      RenderReply reply = {};
+      std::string replyPayload = {};
+      handle(request, payload, &reply, &replyPayload);
+      reply.payloadSize = static_cast<uint32_t>(replyPayload.size());
+      if (!WriteFully(fd, &reply, sizeof(reply)) ||
+          !WriteFully(fd, replyPayload.data(), replyPayload.size())) {
+        return;
+      }
+    }
+  }
+
+ private:
+  int fd = -1;
+  std::shared_ptr<PAGFile> file = nullptr;
+  std::shared_ptr<PAGSurface> surface = nullptr;
+  std::shared_ptr<PAGPlayer> player = std::make_shared<PAGPlayer>();
+  std::string ringName = {};
+  RingHeader* ring = nullptr;
+  size_t ringSize = 0;
+  int nextSlot = 0;
+
+  void handle(const RenderRequest& request, const std::string& payload, RenderReply* reply,
+              std::string* replyPayload) {
+    switch (request.command) {
+      case RenderCommand::LoadFile:
+      case RenderCommand::LoadData:
+        loadFile(request.command, payload, reply);
+        break;
+      case RenderCommand::SetupRing:
+        setupRing(request, reply, replyPayload);
+        break;
+      case RenderCommand::RenderFrame:
+        renderFrame(request, reply);
+        break;
+      default:
+        reply->status = RenderStatus::Failed;
+        break;
+    }
+  }
+
+  void loadFile(RenderCommand command, const std::string& payload, RenderReply* reply) {
+    if (command == RenderCommand::LoadFile) {
+      file = PAGFile::Load(payload);
+    } else {
+      file = PAGFile::Load(payload.data(), payload.size());
+    }
+    player->setComposition(file);
+    if (file == nullptr) {
+      reply->status = RenderStatus::Failed;
+      return;
+    }
+    reply->status = RenderStatus::OK;
+    reply->values[0] = file->width();
+    reply->values[1] = file->height();
+    reply->values[2] = file->duration();
+    reply->value = file->frameRate();
+  }
+
+  void setupRing(const RenderRequest& request, RenderReply* reply, std::string* replyPayload) {
+    releaseRing();
+    auto width = static_cast<int>(request.args[0]);
+    auto height = static_cast<int>(request.args[1]);
+    auto slotCount = static_cast<int>(request.args[2]);
+    if (width <= 0 || height <= 0 || slotCount <= 0 || slotCount > MaxRingSlots) {
+      reply->status = RenderStatus::Failed;
+      return;
+    }
+    surface = PAGSurface::MakeOffscreen(width, height);
+    player->setSurface(surface);
+    if (surface == nullptr) {
+      reply->status = RenderStatus::Failed;
+      return;
+    }
+    ringName = "/pag4j-" + std::to_string(getpid()) + "-" + std::to_string(sessionCount++);
+    auto shmFD = shm_open(ringName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (shmFD < 0) {
+      ringName.clear();
+      reply->status = RenderStatus::Failed;
+      return;
+    }
+    ringSize = RingMappingSize(width, height, slotCount);
+    void* mapping = MAP_FAILED;
+    if (ftruncate(shmFD, static_cast<off_t>(ringSize)) == 0) {
+      mapping = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFD, 0);
+    }
+    close(shmFD);
+    if (mapping == MAP_FAILED) {
+      releaseRing();
+      reply->status = RenderStatus::Failed;
+      return;
+    }
+    ring = new (mapping) RingHeader();
+    ring->width = width;
+    ring->height = height;
+    ring->slotCount = slotCount;
+    for (int i = 0; i < MaxRingSlots; i++) {
+      ring->states[i].store(RingSlotFree);
+      ring->frames[i] = -1;
+    }
+    ring->magic = RingMagic;
+    nextSlot = 0;
+    reply->status = RenderStatus::OK;
+    *replyPayload = ringName;
+  }
+
+  void renderFrame(const RenderRequest& request, RenderReply* reply) {
+    if (ring == nullptr || file == nullptr) {
+      reply->status = RenderStatus::Failed;
+      return;
+    }
+    int slot = -1;
+    for (int i = 0; i < ring->slotCount; i++) {
+      auto index = (nextSlot + i) % ring->slotCount;
+      uint32_t expected = RingSlotFree;
+      if (ring->states[index].compare_exchange_strong(expected, RingSlotRendering)) {
+        slot = index;
+        break;
+      }
+    }
+    if (slot < 0) {
+      reply->status = RenderStatus::Busy;
+      return;
+    }
+    nextSlot = (slot + 1) % ring->slotCount;
+    player->setProgress(request.progress);
+    player->flush();
+    auto pixels = reinterpret_cast<uint8_t*>(ring) + RingHeaderSize +
+                  RingSlotSize(ring->width, ring->height) * slot;
+    auto success = surface->readPixels(ColorType::RGBA_8888, AlphaType::Premultiplied, pixels,
+                                       static_cast<size_t>(ring->width) * 4);
+    ring->frames[slot] = request.args[0];
+    ring->states[slot].store(success ? RingSlotReady : RingSlotFree, std::memory_order_release);
+    reply->status = success ? RenderStatus::OK : RenderStatus::Failed;
+    reply->values[0] = slot;
+  }
+
+  void releaseRing() {
+    if (ring != nullptr) {
+      munmap(ring, ringSize);
+      ring = nullptr;
+    }
+    if (!ringName.empty()) {
+      // The client unlinks the name once it has mapped the ring as well, either side suffices.
+      shm_unlink(ringName.c_str());
+      ringName.clear();
+    }
+  }
+};
+
+static void WatchStdin() {
+  char buffer[256];
+  while (read(STDIN_FILENO, buffer, sizeof(buffer)) > 0) {
+  }
+  _exit(0);
+}
+
+int main(int argc, char* argv[]) {
+  bool watchStdin = false;
+  std::string socketPath = {};
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--watch-stdin") == 0) {
+      watchStdin = true;
+    } else {
+      socketPath = argv[i];
+    }
+  }
+  if (socketPath.empty() || socketPath.size() > MaxSocketPathLength) {
+    fprintf(stderr, "Usage: pag4j-server [--watch-stdin] <socket path>\n");
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  auto serverFD = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (serverFD < 0) {
+    perror("pag4j-server: socket");
+    return 1;
+  }
+  // The socket is bound to a temporary name and only renamed to the socket path once it listens,
+  // so a client that sees the path can connect right away.
+  auto bindPath = socketPath + ".tmp";
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, bindPath.c_str(), sizeof(address.sun_path) - 1);
+  unlink(bindPath.c_str());
+  if (bind(serverFD, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(serverFD, 16) != 0) {
+    perror("pag4j-server: bind");
+    unlink(bindPath.c_str());
+    return 1;
+  }
+  if (rename(bindPath.c_str(), socketPath.c_str()) != 0) {
+    perror("pag4j-server: rename");
+    unlink(bindPath.c_str());
+    return 1;
+  }
+  if (watchStdin) {
+    std::thread(WatchStdin).detach();
+  }
+  while (true) {
+    auto clientFD = accept(serverFD, nullptr, nullptr);
+    if (clientFD < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("pag4j-server: accept");
+      break;
+    }
+    std::thread([clientFD] {
+      RenderSession session(clientFD);
+      session.run();
+    }).detach();
+  }
+  close(serverFD);
+  unlink(socketPath.c_str());
+  return 0;
+}
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Tencent is pleased to support the open source community by making libpag available.
+//
+//  Copyright (C) 2021 THL A29 Limited, a Tencent company. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+//  except in compliance with the License. You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  unless required by applicable law or agreed to in writing, software distributed under the
+//  license is distributed on an "as is" basis, without warranties or conditions of any kind,
+//  either express or implied. see the license for the specific language governing permissions
+//  and limitations under the license.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+// pag4j-bake renders a pag file into the sidecar of pre-rendered frames read by PAGBakedFrames,
+// and prints what each child layer of the root composition costs per frame. Usage:
+//
+//     pag4j-bake [--scale <scale>] <pag file> <output file>
+//
+// Files with editable text or image layers are baked up to the lowest of them, since those layers
+// and everything drawn over them have to stay live. The exit code is 0 if the whole file was
+// baked, 2 if it was baked in part or only measured and 1 on failure.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "JBakeFormat.h"
+#include "pag/pag.h"
+
+using namespace pag;
+
+static const char* LayerTypeName(LayerType type) {
+  switch (type) {
+    case LayerType::Null:
+      return "null";
+    case LayerType::Solid:
+      return "solid";
+    case LayerType::Text:
+      return "text";
+    case LayerType::Shape:
+      return "shape";
+    case LayerType::Image:
+      return "image";
+    case LayerType::PreCompose:
+      return "precompose";
+    case LayerType::Camera:
+      return "camera";
+    default:
+      return "unknown";
+  }
+}
+
+static void PrintReport(const BakeReport& report) {
+  printf("frames: %lld, unique: %lld, size: %dx%d\n", static_cast<long long>(report.numFrames),
+         static_cast<long long>(report.uniqueFrames), report.width, report.height);
+  printf("render: %lld us/frame", static_cast<long long>(report.frameCost));
+  if (report.baked) {
+    printf(", baked read: %lld us/frame, %lld bytes", static_cast<long long>(report.readCost),
+           static_cast<long long>(report.bakedBytes));
+  }
+  printf("\n");
+  int64_t savedCost = 0;
+  for (auto& layer : report.layers) {
+    printf("  %-32s %-10s %8lld us/frame%s%s\n", layer.name.c_str(), LayerTypeName(layer.type),
+           static_cast<long long>(layer.cost), layer.live ? "  live" : "",
+           layer.baked ? "  baked" : "");
+    if (layer.baked) {
+      savedCost += layer.cost;
+    }
+  }
+  if (!report.baked) {
+    printf("not baked: the bottom layer is live\n");
+  } else if (report.bakedLayers < static_cast<int>(report.layers.size())) {
+    printf("baked %d of %d layers, saving %lld us/frame\n", report.bakedLayers,
+           static_cast<int>(report.layers.size()), static_cast<long long>(savedCost));
+  }
+}
+
+int main(int argc, char* argv[]) {
+  float scale = 1.0f;
+  std::string inputPath = {};
+  std::string outputPath = {};
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+      scale = static_cast<float>(atof(argv[++i]));
+    } else if (inputPath.empty()) {
+      inputPath = argv[i];
+    } else {
+      outputPath = argv[i];
+    }
+  }
+  if (inputPath.empty() || outputPath.empty() || !(scale > 0)) {
+    fprintf(stderr, "Usage: pag4j-bake [--scale <scale>] <pag file> <output file>\n");
+    return 1;
+  }
+  auto file = PAGFile::Load(inputPath);
+  if (file == nullptr) {
+    fprintf(stderr, "pag4j-bake: %s is not a valid pag file\n", inputPath.c_str());
+    return 1;
+  }
+  BakeReport report = {};
+  if (!BakeFile(file, scale, outputPath, &report)) {
+    fprintf(stderr, "pag4j-bake: failed to bake %s\n", inputPath.c_str());
+    return 1;
+  }
+  PrintReport(report);
+  return report.baked && report.bakedLayers == static_cast<int>(report.layers.size()) ? 0 : 2;
+}
@@ -1,11 +1,95 @@
 package org.libpag;
 
 public class PAG {
+    /**
+     * Options for {@link #prewarm(PrewarmOptions, PrewarmListener)}.
+     */
+    public static class PrewarmOptions {
+        /**
+         * The path of a sample pag file to render during prewarming, which also initializes the
+         * fonts, decoders and shaders it requires. Only the graphics context and the basic shaders
+         * are initialized if it is null.
+         */
+        public String samplePath = null;
+        /**
+         * The size of the offscreen surface created for prewarming. Use the size of the first
+         * animation to display so that the returned surface can be reused for it.
+         */
+        public int width = 256;
+        public int height = 256;
+    }
+
+    public interface PrewarmListener {
+        /**
+         * Called on the prewarm thread when prewarming is done. The surface is the prewarmed
+         * offscreen surface, which already holds the compiled shaders and can be passed to the
+         * first PAGPlayer, or null if prewarming failed.
+         */
+        void onPrewarmed(PAGSurface surface);
+    }
+
     /**
      * Get SDK version information.
      */
     public static native String SDKVersion();
 
+    /**
+     * Runs the one-time initializations of the first flush() on a background thread: creating the
+     * graphics context, compiling shaders, setting up the font cache and initializing decoders. Call
+     * it at startup so that the first visible animation does not drop frames.
+     */
+    public static void prewarm(final PrewarmOptions options, final PrewarmListener listener) {
+        final PrewarmOptions prewarmOptions = options != null ? options : new PrewarmOptions();
+        Thread thread = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                long nativeSurface = nativePrewarm(prewarmOptions.samplePath, prewarmOptions.width,
+                        prewarmOptions.height);
+                PAGSurface surface = nativeSurface != 0 ? new PAGSurface(nativeSurface) : null;
+                if (listener != null) {
+                    listener.onPrewarmed(surface);
+                } else if (surface != null) {
+                    surface.release();
+                }
+            }
+        }, "PAGPrewarm");
+        thread.setDaemon(true);
+        thread.start();
+    }
+
+    private static native long nativePrewarm(String samplePath, int width, int height);
+
+    /**
+     * Starts recording trace events of the native bindings and the libpag calls inside them, such
+     * as loading files, flushing, and reading pixels back, with one timeline per thread. The events
+     * are kept in a ring buffer which holds the latest bufferSize events, and any previously
+     * recorded events are discarded. Tracing is disabled by default and costs almost nothing then.
+     */
+    public static native void startTracing(int bufferSize);
+
+    /**
+     * Stops recording trace events. The recorded events are kept until the next startTracing()
+     * call.
+     */
+    public static native void stopTracing();
+
+    /**
+     * Returns true if trace events are being recorded.
+     */
+    public static native boolean isTracing();
+
+    /**
+     * Returns the recorded trace events in the Chrome trace-event JSON format, which can be opened
+     * in chrome://tracing or ui.perfetto.dev.
+     */
+    public static native String traceToJSON();
+
+    /**
+     * Writes the recorded trace events to the file in the Chrome trace-event JSON format. Returns
+     * false if the file could not be written.
+     */
+    public static native boolean writeTrace(String path);
+
     static {
         LibraryLoadUtils.loadLibrary("pag4j");
     }
@@ -0,0 +1,96 @@
+package org.libpag;
+
+/**
+ * Moves the pixel readback of each frame off the calling thread. Each call of renderFrame()
+ * flushes the player into an offscreen surface and signals a fence, a native worker thread waits
+ * on that fence and reads the frame back while the caller moves on, for example to encode the
+ * previous frame or to update the layers for the next one. Only the caller's own work overlaps
+ * with the readback: the GPU rendering of the next frame does not, since there is a single
+ * surface and renderFrame() first waits until the previous frame has been read back. The player
+ * keeps rendering on one GPU device, so its graphics caches survive between frames.
+ */
+public class PAGAsyncReadback {
+
+    /**
+     * Creates a PAGAsyncReadback with an offscreen surface of the specified size. Returns null if
+     * the surface could not be created.
+     */
+    public static PAGAsyncReadback Make(int width, int height) {
+        long nativeContext = SetupReadback(width, height);
+        if (nativeContext == 0) {
+            return null;
+        }
+        return new PAGAsyncReadback(nativeContext);
+    }
+
+    private static native long SetupReadback(int width, int height);
+
+    private PAGAsyncReadback(long nativeContext) {
+        this.nativeContext = nativeContext;
+    }
+
+    /**
+     * The width of the surface in pixels.
+     */
+    public native int width();
+
+    /**
+     * The height of the surface in pixels.
+     */
+    public native int height();
+
+    /**
+     * Renders the current progress of the player and queues the frame for readback. It blocks until
+     * the frame rendered by the previous call has been read back. The player's surface is replaced
+     * by the offscreen surface. Returns true if the content has changed.
+     */
+    public boolean renderFrame(PAGPlayer player) {
+        if (player == null) {
+            return false;
+        }
+        if (player.getSurface() != null) {
+            player.setSurface(null);
+        }
+        return nativeRenderFrame(player);
+    }
+
+    private native boolean nativeRenderFrame(PAGPlayer player);
+
+    /**
+     * Detaches the player from the surface and waits until the last rendered frame has been read
+     * back. Call it after the final renderFrame() call so that copyLatestFrameTo() returns that
+     * frame.
+     */
+    public void finish(PAGPlayer player) {
+        nativeFinish(player);
+    }
+
+    private native void nativeFinish(PAGPlayer player);
+
+    /**
+     * Copies the latest completed frame to the specified bitmap. Returns the sequence number of the
+     * copied frame, which counts the renderFrame() calls starting from 0, or -1 if no frame has been
+     * read back yet.
+     */
+    public native long copyLatestFrameTo(byte[] pixels, int stride);
+
+    /**
+     * Free up resources used by the PAGAsyncReadback instance immediately instead of relying on the
+     * garbage collector to do this for you at some point in the future.
+     */
+    public void release() {
+        nativeRelease();
+    }
+
+    private native void nativeRelease();
+
+    protected void finalize() {
+        nativeRelease();
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private long nativeContext = 0;
+}
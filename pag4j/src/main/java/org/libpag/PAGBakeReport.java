@@ -0,0 +1,135 @@
+package org.libpag;
+
+/**
+ * The result of {@link PAGBakedFrames#Bake(PAGFile, float, String)}: the size of the baked frames
+ * and what each child layer of the root composition costs to render.
+ */
+public class PAGBakeReport {
+    private final boolean baked;
+    private final int width;
+    private final int height;
+    private final long numFrames;
+    private final long uniqueFrames;
+    private final long bakedBytes;
+    private final long frameCost;
+    private final long readCost;
+    private final String[] layerNames;
+    private final int[] layerTypes;
+    private final boolean[] liveLayers;
+    private final boolean[] bakedLayers;
+    private final long[] layerCosts;
+
+    PAGBakeReport(boolean baked, int width, int height, long numFrames, long uniqueFrames,
+                  long bakedBytes, long frameCost, long readCost, String[] layerNames,
+                  int[] layerTypes, boolean[] liveLayers, boolean[] bakedLayers,
+                  long[] layerCosts) {
+        this.baked = baked;
+        this.width = width;
+        this.height = height;
+        this.numFrames = numFrames;
+        this.uniqueFrames = uniqueFrames;
+        this.bakedBytes = bakedBytes;
+        this.frameCost = frameCost;
+        this.readCost = readCost;
+        this.layerNames = layerNames;
+        this.layerTypes = layerTypes;
+        this.liveLayers = liveLayers;
+        this.bakedLayers = bakedLayers;
+        this.layerCosts = layerCosts;
+    }
+
+    /**
+     * Returns true if the frames were written, of the whole file or of the child layers beneath
+     * the lowest live layer. A file whose bottom child layer is live is only measured.
+     */
+    public boolean baked() {
+        return baked;
+    }
+
+    /**
+     * The width of the baked frames in pixels.
+     */
+    public int width() {
+        return width;
+    }
+
+    /**
+     * The height of the baked frames in pixels.
+     */
+    public int height() {
+        return height;
+    }
+
+    /**
+     * The number of frames of the file.
+     */
+    public long numFrames() {
+        return numFrames;
+    }
+
+    /**
+     * The number of frames stored, the other frames repeat the frame before them.
+     */
+    public long uniqueFrames() {
+        return uniqueFrames;
+    }
+
+    /**
+     * The size of the baked file in bytes.
+     */
+    public long bakedBytes() {
+        return bakedBytes;
+    }
+
+    /**
+     * The average time in microseconds to render a frame of the file at the baked size.
+     */
+    public long frameCost() {
+        return frameCost;
+    }
+
+    /**
+     * The average time in microseconds to read a baked frame, 0 if nothing was baked.
+     */
+    public long readCost() {
+        return readCost;
+    }
+
+    /**
+     * The names of the child layers of the root composition.
+     */
+    public String[] layerNames() {
+        return layerNames.clone();
+    }
+
+    /**
+     * The types of the child layers, one of the PAGLayer.LayerType constants.
+     */
+    public int[] layerTypes() {
+        return layerTypes.clone();
+    }
+
+    /**
+     * Whether each child layer is or contains an editable text or image layer, which has to stay
+     * live along with every layer above it.
+     */
+    public boolean[] liveLayers() {
+        return liveLayers.clone();
+    }
+
+    /**
+     * Whether each child layer is drawn from the baked frames instead of being rendered. These
+     * are the layers beneath the lowest live layer, or all layers if none is live.
+     */
+    public boolean[] bakedLayers() {
+        return bakedLayers.clone();
+    }
+
+    /**
+     * The average time in microseconds each child layer adds to rendering a frame, which is saved
+     * per frame for the baked layers by playing the baked frames instead.
+     */
+    public long[] layerCosts() {
+        return layerCosts.clone();
+    }
+}
@@ -0,0 +1,141 @@
+package org.libpag;
+
+/**
+ * The pre-rendered frames of a PAGFile, stored in a sidecar file next to it. Playing a heavy
+ * template with many masks and effects from its baked frames costs a read and a copy per frame
+ * instead of rendering, which suits low-end clients as long as the content is never edited.
+ * Frames that render the same content as the frame before them are stored once. The frames are
+ * compressed if zlib is available when pag4j is built, and such files can only be opened by
+ * builds with zlib. The sidecar is written in the byte order of the machine that bakes it.
+ * Templates with editable text or image layers are baked in part: the child layers of the root
+ * composition beneath the lowest editable one are baked, the rest stays live. To play them, call
+ * hideBakedLayers() on the PAGFile, render it with a PAGPlayer to a surface of the baked size,
+ * copy its pixels with PAGSurface.copyPixelsTo() and draw the baked frame beneath them with
+ * compositeFrame(). Live layers with a blend mode other than normal blend with transparency
+ * instead of the baked layers beneath them, such templates should be checked visually.
+ * The pag4j-bake tool bakes files from the command line in the same way.
+ */
+public class PAGBakedFrames {
+    /**
+     * Renders the original content of the file at the scale and writes its frames to the path,
+     * then reads them back to measure the playback cost. Every child layer of the root composition
+     * is measured by rendering sampled frames with and without it. If the file has editable text
+     * or image layers, only the child layers beneath the lowest of them are baked, since those
+     * layers and everything drawn over them have to stay live, see PAGBakeReport.bakedLayers().
+     * If the bottom child layer is editable, nothing is written and the report only contains the
+     * measurements. Returns null if the file could not be rendered or written.
+     */
+    public static PAGBakeReport Bake(PAGFile pagFile, float scale, String path) {
+        if (pagFile == null || path == null) {
+            return null;
+        }
+        return BakeFile(pagFile, scale, path);
+    }
+
+    private static native PAGBakeReport BakeFile(PAGFile pagFile, float scale, String path);
+
+    /**
+     * Opens the frames baked to the path. Returns null if the file does not exist or is not
+     * supported by this build.
+     */
+    public static PAGBakedFrames Open(String path) {
+        if (path == null) {
+            return null;
+        }
+        long nativeContext = OpenFile(path);
+        if (nativeContext == 0) {
+            return null;
+        }
+        return new PAGBakedFrames(nativeContext);
+    }
+
+    private static native long OpenFile(String path);
+
+    private PAGBakedFrames(long nativeContext) {
+        this.nativeContext = nativeContext;
+    }
+
+    /**
+     * The width of the frames in pixels.
+     */
+    public native int width();
+
+    /**
+     * The height of the frames in pixels.
+     */
+    public native int height();
+
+    /**
+     * The frame rate of the baked file.
+     */
+    public native float frameRate();
+
+    /**
+     * The number of frames.
+     */
+    public native long numFrames();
+
+    /**
+     * The number of child layers of the root composition of the baked file.
+     */
+    public native int numLayers();
+
+    /**
+     * The number of child layers in the frames, counted from the bottom. The frames hold the whole
+     * file if it equals numLayers(), otherwise the layers above have to be rendered live.
+     */
+    public native int bakedLayers();
+
+    /**
+     * Hides the baked child layers of the file, which has to be the file the frames were baked
+     * from, so a PAGPlayer only renders the live layers. Returns false and changes nothing if the
+     * number of child layers of the file differs from numLayers().
+     */
+    public boolean hideBakedLayers(PAGFile pagFile) {
+        if (pagFile == null || pagFile.numChildren() != numLayers()) {
+            return false;
+        }
+        int count = bakedLayers();
+        for (int i = 0; i < count; i++) {
+            PAGLayer layer = pagFile.getLayerAt(i);
+            if (layer != null) {
+                layer.setVisible(false);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Copies the RGBA pixels of the frame, with premultiplied alpha, to the array, stride bytes
+     * per row. Returns false if the frame is out of range, the array is too small or the frame
+     * could not be read.
+     */
+    public native boolean readFrame(long frame, byte[] pixels, int stride);
+
+    /**
+     * Draws the frame beneath the RGBA pixels with premultiplied alpha already in the array,
+     * stride bytes per row, which hold the live layers rendered on a transparent surface. Returns
+     * false if the frame is out of range, the array is too small or the frame could not be read.
+     */
+    public native boolean compositeFrame(long frame, byte[] pixels, int stride);
+
+    /**
+     * Free up resources used by the PAGBakedFrames instance immediately instead of relying on the
+     * garbage collector to do this for you at some point in the future.
+     */
+    public void release() {
+        nativeRelease();
+    }
+
+    private native void nativeRelease();
+
+    protected void finalize() {
+        nativeRelease();
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private long nativeContext = 0;
+}
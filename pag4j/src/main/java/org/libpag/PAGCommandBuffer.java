@@ -0,0 +1,170 @@
+package org.libpag;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+
+/**
+ * Records layer mutations into a direct buffer and applies all of them with a single native call.
+ * Use it instead of calling the PAGLayer setters one by one when driving many layers every frame.
+ * The recorded layers are kept alive until the buffer is applied or cleared.
+ * Note: PAGCommandBuffer is not thread-safe, record and apply it on the same thread.
+ */
+public class PAGCommandBuffer {
+    static final int OpSetMatrix = 1;
+    static final int OpResetMatrix = 2;
+    static final int OpSetVisible = 3;
+    static final int OpSetStartTime = 4;
+    static final int OpSetCurrentTime = 5;
+    static final int OpSetProgress = 6;
+    static final int OpSetLayerIndex = 7;
+
+    public PAGCommandBuffer() {
+        this(4096);
+    }
+
+    /**
+     * Creates a command buffer with the specified initial capacity in bytes. The buffer grows
+     * automatically when more commands are recorded.
+     */
+    public PAGCommandBuffer(int initialCapacity) {
+        buffer = ByteBuffer.allocateDirect(Math.max(initialCapacity, 64)).order(ByteOrder.nativeOrder());
+    }
+
+    /**
+     * Records PAGLayer.setMatrix(). The matrix must contain at least 9 values.
+     */
+    public void setMatrix(PAGLayer layer, float[] matrix) {
+        if (layer == null || matrix == null || matrix.length < 9) {
+            return;
+        }
+        begin(OpSetMatrix, layer, 36);
+        for (int i = 0; i < 9; i++) {
+            buffer.putFloat(matrix[i]);
+        }
+    }
+
+    /**
+     * Records PAGLayer.resetMatrix().
+     */
+    public void resetMatrix(PAGLayer layer) {
+        if (layer == null) {
+            return;
+        }
+        begin(OpResetMatrix, layer, 0);
+    }
+
+    /**
+     * Records PAGLayer.setVisible().
+     */
+    public void setVisible(PAGLayer layer, boolean value) {
+        if (layer == null) {
+            return;
+        }
+        begin(OpSetVisible, layer, 4);
+        buffer.putInt(value ? 1 : 0);
+    }
+
+    /**
+     * Records PAGLayer.setStartTime(), in microseconds.
+     */
+    public void setStartTime(PAGLayer layer, long time) {
+        if (layer == null) {
+            return;
+        }
+        begin(OpSetStartTime, layer, 8);
+        buffer.putLong(time);
+    }
+
+    /**
+     * Records PAGLayer.setCurrentTime(), in microseconds.
+     */
+    public void setCurrentTime(PAGLayer layer, long time) {
+        if (layer == null) {
+            return;
+        }
+        begin(OpSetCurrentTime, layer, 8);
+        buffer.putLong(time);
+    }
+
+    /**
+     * Records PAGLayer.setProgress().
+     */
+    public void setProgress(PAGLayer layer, double value) {
+        if (layer == null) {
+            return;
+        }
+        begin(OpSetProgress, layer, 8);
+        buffer.putDouble(value);
+    }
+
+    /**
+     * Records PAGComposition.setLayerIndex().
+     */
+    public void setLayerIndex(PAGComposition composition, PAGLayer layer, int index) {
+        if (composition == null || layer == null) {
+            return;
+        }
+        begin(OpSetLayerIndex, composition, 12);
+        layers.add(layer);
+        buffer.putLong(layer.nativeContext);
+        buffer.putInt(index);
+    }
+
+    /**
+     * Returns the number of recorded commands.
+     */
+    public int size() {
+        return count;
+    }
+
+    /**
+     * Applies all recorded commands in the order they were recorded, and then clears the buffer.
+     * Returns the number of commands applied.
+     */
+    public int apply() {
+        if (count == 0) {
+            return 0;
+        }
+        int applied = nativeApply(buffer, buffer.position());
+        clear();
+        return applied;
+    }
+
+    /**
+     * Discards all recorded commands.
+     */
+    public void clear() {
+        buffer.clear();
+        layers.clear();
+        count = 0;
+    }
+
+    private void begin(int op, PAGLayer layer, int payloadSize) {
+        int required = 12 + payloadSize;
+        if (buffer.remaining() < required) {
+            int capacity = buffer.capacity();
+            while (capacity - buffer.position() < required) {
+                capacity *= 2;
+            }
+            ByteBuffer newBuffer = ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder());
+            buffer.flip();
+            newBuffer.put(buffer);
+            buffer = newBuffer;
+        }
+        layers.add(layer);
+        buffer.putInt(op);
+        buffer.putLong(layer.nativeContext);
+        count++;
+    }
+
+    private static native int nativeApply(ByteBuffer buffer, int size);
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private ByteBuffer buffer;
+    private final ArrayList<PAGLayer> layers = new ArrayList<>();
+    private int count = 0;
+}
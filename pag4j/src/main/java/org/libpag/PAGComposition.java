@@ -104,10 +104,17 @@ public class PAGComposition extends PAGLayer {
      */
     public native long audioStartTime();
 
-    private static native void nativeInit();
+    /**
+     * Returns the indices of the child layers that are active at the specified time, in ascending
+     * order. The time is in microseconds on the timeline of this composition, which the start times
+     * of the child layers are on as well, and a layer is active from its start time until its start
+     * time plus its duration. Layers excluded from the timeline are always active. The time ranges
+     * are kept in an interval tree that is rebuilt after the layers are added, removed or retimed,
+     * so the cost of a call grows with the number of active layers instead of all the layers.
+     */
+    public native int[] getActiveLayerIndices(long time);
 
     static {
         LibraryLoadUtils.loadLibrary("pag4j");
-        nativeInit();
     }
 }
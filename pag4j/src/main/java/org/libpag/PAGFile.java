@@ -18,6 +18,9 @@
 
 package org.libpag;
 
+import java.util.concurrent.CompletableFuture;
+import java.util.function.Consumer;
+
 public class PAGFile extends PAGComposition {
 
     public interface LoadListener {
@@ -48,6 +51,105 @@ public class PAGFile extends PAGComposition {
         return LoadFromBytes(bytes, bytes.length, "");
     }
 
+    /**
+     * Loads a pag file from the specified path on a native loader thread. The future completes with
+     * null if the file does not exist or the data is not a pag file. Files loaded at the same time
+     * are parsed in parallel, and the callbacks attached to the futures all run on one dispatcher
+     * thread, so they should hand the result to the UI thread instead of doing heavy work there.
+     * Cancelling the future drops the load if it has not started yet.
+     */
+    public static CompletableFuture<PAGFile> LoadAsync(String path) {
+        return PAGFileLoader.LoadFromPath(path);
+    }
+
+    /**
+     * Parses the pag file data on a native loader thread, see {@link #LoadAsync(String)}.
+     */
+    public static CompletableFuture<PAGFile> LoadAsync(byte[] bytes) {
+        return PAGFileLoader.LoadFromBytes(bytes, bytes.length, "");
+    }
+
+    /**
+     * Loads a pag file from the specified path on a native loader thread, and calls the listener on
+     * the dispatcher thread when it is done.
+     */
+    public static void LoadAsync(String path, final LoadListener listener) {
+        LoadAsync(path).thenAccept(new Consumer<PAGFile>() {
+            @Override
+            public void accept(PAGFile result) {
+                if (listener != null) {
+                    listener.onLoad(result);
+                }
+            }
+        });
+    }
+
+    /**
+     * Reads the metadata of the pag file at the specified path without decoding it, returns null
+     * if the file does not exist or is not a valid pag file. Only the file header, the tag headers
+     * of the file, its compositions and their layers, and the tags holding the composition
+     * attributes, the layer names and the layer references are read. The encoded bytes of the
+     * images and the bitmap and video sequences are skipped by their length, so they are neither
+     * read from the disk nor held in memory.
+     * Note: A file that can be probed may still fail to load, since most tags are not decoded.
+     */
+    public static PAGFileInfo Probe(String path) {
+        return ProbeFromPath(path);
+    }
+
+    /**
+     * Reads the metadata of the pag file data without creating a PAGFile, see
+     * {@link #Probe(String)}.
+     */
+    public static PAGFileInfo Probe(byte[] bytes) {
+        return ProbeFromBytes(bytes, bytes.length);
+    }
+
+    /**
+     * Loads the pag file at the specified path and renders a thumbnail of it at the specified
+     * progress, see {@link PAGPlayer#RenderThumbnail}. Returns false if the file could not be loaded
+     * or rendered.
+     */
+    public static boolean RenderThumbnail(String path, double progress, int width, int height,
+                                          byte[] pixels, int stride) {
+        return RenderThumbnailFromPath(path, progress, width, height, pixels, stride);
+    }
+
+    private static native boolean RenderThumbnailFromPath(String path, double progress, int width,
+                                                          int height, byte[] pixels, int stride);
+
+    /**
+     * Sets whether PAGFiles loaded with identical contents share their parsed data, the default
+     * value is false. While disabled, loads behave exactly as described at Load() and no file
+     * bytes are read or hashed in addition. While enabled, Load() and LoadAsync() read the whole
+     * file and hash it, regardless of the path or the method used to load it, and every load of
+     * contents already loaded returns a copyOriginal() of the first file, so the images, video
+     * sequences and texts are parsed once, and a PAGPlayer that renders several of these files,
+     * such as a PAGComposition built from them, decodes and uploads each asset only once. The
+     * shared data is released with the last PAGFile that uses it. Disabling it only affects later
+     * loads.
+     * Files with different contents still share the images they embed with identical bytes: each
+     * image is hashed once per distinct content, and every file embedding it draws the same image,
+     * which a PAGPlayer decodes and uploads only once. Images stored at a reduced scale or trimmed
+     * to their opaque area are not shared.
+     * Note: A shared file reports the path of the first file loaded with these contents from
+     * path(), which may be another file with the same bytes.
+     */
+    public static native void SetContentSharing(boolean enabled);
+
+    /**
+     * Returns the results of the content sharing. The array must hold at least 4 values: the number
+     * of distinct contents alive, the number of PAGFiles alive that share them, the number of loads
+     * that reused the data of an earlier file and the bytes those loads did not parse again. If it
+     * has room for 6 values, it also receives the number of distinct images alive and the number of
+     * images that reused the image of another file.
+     */
+    public static native void ContentSharingStats(long[] values);
+
+    private static native PAGFileInfo ProbeFromPath(String path);
+
+    private static native PAGFileInfo ProbeFromBytes(byte[] bytes, int limit);
+
     private static native PAGFile LoadFromPath(String path);
 
     private static native PAGFile LoadFromBytes(byte[] bytes, int limit, String path);
@@ -99,13 +201,13 @@ public class PAGFile extends PAGComposition {
 
     /**
      * Make a copy of the original file, any modification to current file has no effect on the result file.
+     * The copy shares the parsed file data with this file, such as shapes, images, texts and video
+     * sequences, and only duplicates the layer objects that hold the timeline and edits, which makes
+     * it cheap compared to loading the file again.
      */
     public native PAGFile copyOriginal();
 
-    private static native final void nativeInit();
-
     static {
         LibraryLoadUtils.loadLibrary("pag4j");
-        nativeInit();
     }
 }
@@ -0,0 +1,96 @@
+package org.libpag;
+
+/**
+ * The metadata of a pag file returned by {@link PAGFile#Probe(String)}.
+ */
+public class PAGFileInfo {
+    private final int width;
+    private final int height;
+    private final long duration;
+    private final float frameRate;
+    private final int tagLevel;
+    private final int numTexts;
+    private final int numImages;
+    private final int numVideos;
+    private final String[] layerNames;
+
+    PAGFileInfo(int width, int height, long duration, float frameRate, int tagLevel, int numTexts,
+                int numImages, int numVideos, String[] layerNames) {
+        this.width = width;
+        this.height = height;
+        this.duration = duration;
+        this.frameRate = frameRate;
+        this.tagLevel = tagLevel;
+        this.numTexts = numTexts;
+        this.numImages = numImages;
+        this.numVideos = numVideos;
+        this.layerNames = layerNames;
+    }
+
+    /**
+     * The width of the root composition in pixels.
+     */
+    public int width() {
+        return width;
+    }
+
+    /**
+     * The height of the root composition in pixels.
+     */
+    public int height() {
+        return height;
+    }
+
+    /**
+     * The duration of the root composition in microseconds.
+     */
+    public long duration() {
+        return duration;
+    }
+
+    /**
+     * The frame rate of the root composition.
+     */
+    public float frameRate() {
+        return frameRate;
+    }
+
+    /**
+     * The highest tag level found in the tags of the file, its compositions and their layers. The
+     * tags nested in shapes, texts and effects are not read, so the file may require a higher
+     * level, compare it with PAGFile.tagLevel() after loading the file if needed. A value above
+     * PAGFile.MaxSupportedTagLevel() means the file is not fully supported.
+     */
+    public int tagLevel() {
+        return tagLevel;
+    }
+
+    /**
+     * The number of replaceable texts.
+     */
+    public int numTexts() {
+        return numTexts;
+    }
+
+    /**
+     * The number of replaceable images.
+     */
+    public int numImages() {
+        return numImages;
+    }
+
+    /**
+     * The number of video compositions.
+     */
+    public int numVideos() {
+        return numVideos;
+    }
+
+    /**
+     * The names of all layers, in depth-first order starting from the root composition. A
+     * composition referenced by several layers is only visited once.
+     */
+    public String[] layerNames() {
+        return layerNames.clone();
+    }
+}
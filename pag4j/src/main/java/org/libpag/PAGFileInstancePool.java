@@ -0,0 +1,75 @@
+package org.libpag;
+
+import java.util.ArrayDeque;
+
+/**
+ * A pool of independent instances of one PAGFile for rendering it on several threads at once.
+ * Every instance is a copy from PAGFile.copyOriginal(), which shares the parsed file data with the
+ * template and with all other instances, so an instance costs only its layer objects. A thread
+ * acquires an instance, attaches it to its own PAGPlayer, and releases it once done, after which
+ * the instance is handed to the next acquire() instead of being copied again. An acquired instance
+ * is owned by its thread exclusively, instances never block each other while rendering.
+ * Note: The instances start from the original content of the file, edits made to the template are
+ * not visible to them. Edits made to an instance stay when it is released, callers that change an
+ * instance should undo their changes before releasing it.
+ */
+public class PAGFileInstancePool {
+    /**
+     * Creates a pool that keeps at most maxIdleInstances released instances for reuse.
+     */
+    public PAGFileInstancePool(PAGFile template, int maxIdleInstances) {
+        this.template = template;
+        this.maxIdleInstances = Math.max(0, maxIdleInstances);
+    }
+
+    /**
+     * Returns an idle instance, or a new copy of the template if none is idle. Returns null if the
+     * template is null.
+     */
+    public PAGFile acquire() {
+        synchronized (idleInstances) {
+            PAGFile instance = idleInstances.pollFirst();
+            if (instance != null) {
+                return instance;
+            }
+        }
+        return template != null ? template.copyOriginal() : null;
+    }
+
+    /**
+     * Hands an instance acquired from this pool back for reuse. The instance must no longer be
+     * attached to a PAGPlayer or used by the caller afterwards.
+     */
+    public void release(PAGFile instance) {
+        if (instance == null) {
+            return;
+        }
+        synchronized (idleInstances) {
+            if (idleInstances.size() < maxIdleInstances) {
+                idleInstances.addFirst(instance);
+            }
+        }
+    }
+
+    /**
+     * Returns the number of released instances waiting for reuse.
+     */
+    public int idleCount() {
+        synchronized (idleInstances) {
+            return idleInstances.size();
+        }
+    }
+
+    /**
+     * Drops all idle instances, their memory is freed by the garbage collector.
+     */
+    public void clear() {
+        synchronized (idleInstances) {
+            idleInstances.clear();
+        }
+    }
+
+    private final PAGFile template;
+    private final int maxIdleInstances;
+    private final ArrayDeque<PAGFile> idleInstances = new ArrayDeque<>();
+}
@@ -0,0 +1,91 @@
+package org.libpag;
+
+import java.util.HashMap;
+import java.util.concurrent.CompletableFuture;
+
+/**
+ * Runs the asynchronous loads of PAGFile. Files are parsed in parallel by a pool of native threads,
+ * and every finished load is delivered through one queue drained by a single dispatcher thread,
+ * which is also the thread that runs the callbacks attached to the futures.
+ */
+class PAGFileLoader {
+    private static class LoadFuture extends CompletableFuture<PAGFile> {
+        long taskID = 0;
+
+        @Override
+        public boolean cancel(boolean mayInterruptIfRunning) {
+            boolean cancelled = super.cancel(mayInterruptIfRunning);
+            if (cancelled) {
+                synchronized (futures) {
+                    futures.remove(taskID);
+                }
+                nativeCancel(taskID);
+            }
+            return cancelled;
+        }
+    }
+
+    private static final HashMap<Long, LoadFuture> futures = new HashMap<>();
+    private static Thread dispatchThread = null;
+
+    static CompletableFuture<PAGFile> LoadFromPath(String path) {
+        LoadFuture future = new LoadFuture();
+        // Registers the future before the dispatcher can see the result, the load may finish
+        // before nativeLoadFromPath() returns.
+        synchronized (futures) {
+            future.taskID = nativeLoadFromPath(path);
+            futures.put(future.taskID, future);
+            startDispatchThread();
+        }
+        return future;
+    }
+
+    static CompletableFuture<PAGFile> LoadFromBytes(byte[] bytes, int limit, String path) {
+        LoadFuture future = new LoadFuture();
+        synchronized (futures) {
+            future.taskID = nativeLoadFromBytes(bytes, limit, path);
+            futures.put(future.taskID, future);
+            startDispatchThread();
+        }
+        return future;
+    }
+
+    private static void startDispatchThread() {
+        if (dispatchThread != null) {
+            return;
+        }
+        dispatchThread = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                long[] taskID = new long[1];
+                while (true) {
+                    PAGFile file = nativeTakeCompleted(taskID);
+                    LoadFuture future;
+                    synchronized (futures) {
+                        future = futures.remove(taskID[0]);
+                    }
+                    if (future != null) {
+                        future.complete(file);
+                    }
+                }
+            }
+        }, "PAGFileLoader");
+        dispatchThread.setDaemon(true);
+        dispatchThread.start();
+    }
+
+    private static native long nativeLoadFromPath(String path);
+
+    private static native long nativeLoadFromBytes(byte[] bytes, int limit, String path);
+
+    private static native void nativeCancel(long taskID);
+
+    /**
+     * Blocks until a load is finished, returns its result and writes its task ID to taskID[0].
+     */
+    private static native PAGFile nativeTakeCompleted(long[] taskID);
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+}
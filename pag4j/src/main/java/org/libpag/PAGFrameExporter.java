@@ -0,0 +1,117 @@
+package org.libpag;
+
+import java.io.OutputStream;
+
+/**
+ * Exports a frame range of a PAGPlayer as a PNG sequence or a YUV4MPEG2 (Y4M) stream entirely in
+ * native code. Frames are rendered and read back on the calling thread while a pool of native
+ * worker threads encodes them in parallel. At most queueCapacity frames are in flight at once,
+ * so rendering pauses when the encoders or the output fall behind. Encoded frames are always
+ * written in frame order on the calling thread.
+ * Note: The player must have a surface and a composition, and its progress is changed by the
+ * export. PNG frames keep the alpha channel, Y4M frames are composited over black and use BT.601
+ * 4:2:0, which can be piped into ffmpeg directly. If PAGStaticFrames are attached to the player,
+ * duplicate frames are written again from the previous frame's encoded data without rendering.
+ */
+public class PAGFrameExporter {
+    /**
+     * Encodes every frame as a PNG image with alpha.
+     */
+    public static final int FormatPNG = 0;
+    /**
+     * Writes all frames as one uncompressed YUV4MPEG2 stream.
+     */
+    public static final int FormatY4M = 1;
+
+    /**
+     * Creates an exporter with one encoding thread per available processor.
+     */
+    public static PAGFrameExporter Make(int format) {
+        int threadCount = Runtime.getRuntime().availableProcessors();
+        return Make(format, threadCount, threadCount * 2);
+    }
+
+    /**
+     * Creates an exporter with the specified number of encoding threads and the maximum number of
+     * frames that can be rendered but not yet written. Returns null if the format is unknown or
+     * threadCount is not positive.
+     */
+    public static PAGFrameExporter Make(int format, int threadCount, int queueCapacity) {
+        long nativeContext = SetupExporter(format, threadCount, queueCapacity);
+        if (nativeContext == 0) {
+            return null;
+        }
+        return new PAGFrameExporter(nativeContext);
+    }
+
+    private static native long SetupExporter(int format, int threadCount, int queueCapacity);
+
+    private PAGFrameExporter(long nativeContext) {
+        this.nativeContext = nativeContext;
+    }
+
+    /**
+     * Exports the frames in [startFrame, endFrame) to the directory, which must exist. PNG frames
+     * are named by their frame numbers padded to 6 digits, such as 000042.png, and a Y4M export is
+     * written to frames.y4m. The range is clamped to the frames of the player's composition.
+     * Returns false if the player has no surface or composition, or if any frame failed to render,
+     * encode or write.
+     */
+    public boolean exportToDirectory(PAGPlayer player, long startFrame, long endFrame,
+                                     String directory) {
+        if (player == null || directory == null) {
+            return false;
+        }
+        return nativeExportToDirectory(player, startFrame, endFrame, directory);
+    }
+
+    private native boolean nativeExportToDirectory(PAGPlayer player, long startFrame,
+                                                   long endFrame, String directory);
+
+    /**
+     * Exports the frames in [startFrame, endFrame) to the stream, which is not closed afterwards.
+     * PNG frames are written back to back as an image2pipe sequence. Returns false if the player
+     * has no surface or composition, or if any frame failed to render, encode or write.
+     */
+    public boolean exportToStream(PAGPlayer player, long startFrame, long endFrame,
+                                  OutputStream stream) {
+        if (player == null || stream == null) {
+            return false;
+        }
+        return nativeExportToStream(player, startFrame, endFrame, stream);
+    }
+
+    private native boolean nativeExportToStream(PAGPlayer player, long startFrame, long endFrame,
+                                                OutputStream stream);
+
+    /**
+     * Returns the number of frames written by the last export.
+     */
+    public native long frameCount();
+
+    /**
+     * Returns the throughput of the last export in frames per second, measured from the first
+     * render to the last write.
+     */
+    public native double framesPerSecond();
+
+    /**
+     * Free up resources used by the PAGFrameExporter instance immediately instead of relying on the
+     * garbage collector to do this for you at some point in the future.
+     */
+    public void release() {
+        nativeRelease();
+    }
+
+    private native void nativeRelease();
+
+    protected void finalize() {
+        nativeRelease();
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private long nativeContext = 0;
+}
@@ -0,0 +1,52 @@
+package org.libpag;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Fingerprints of rendered frames for deduplicating them in export pipelines, such as frames that
+ * repeat across personalized variants of a template. The exact hash is XXH64 of the RGBA pixels,
+ * ignoring the padding of each row, so equal hashes identify identical frames for all practical
+ * purposes. The perceptual hash is a 64-bit average hash of an 8 x 8 luma grid, frames that look
+ * alike differ in only a few bits, see Distance(). PAGSurface.copyPixelsTo() can compute both while
+ * the pixels are copied out of the surface.
+ */
+public class PAGFrameFingerprint {
+    /**
+     * Returns the exact hash of the premultiplied RGBA pixels in the direct buffer, or 0 if the
+     * buffer is not direct or too small.
+     */
+    public static long Hash(ByteBuffer pixels, int width, int height, int stride) {
+        if (pixels == null || !pixels.isDirect()) {
+            return 0;
+        }
+        return nativeHash(pixels, width, height, stride);
+    }
+
+    private static native long nativeHash(ByteBuffer pixels, int width, int height, int stride);
+
+    /**
+     * Returns the perceptual hash of the premultiplied RGBA pixels in the direct buffer, or 0 if
+     * the buffer is not direct or too small.
+     */
+    public static long PerceptualHash(ByteBuffer pixels, int width, int height, int stride) {
+        if (pixels == null || !pixels.isDirect()) {
+            return 0;
+        }
+        return nativePerceptualHash(pixels, width, height, stride);
+    }
+
+    private static native long nativePerceptualHash(ByteBuffer pixels, int width, int height,
+                                                    int stride);
+
+    /**
+     * Returns the number of differing bits of two perceptual hashes, from 0 for frames that look
+     * the same to 64. Frames within a distance of about 5 are usually indistinguishable.
+     */
+    public static int Distance(long perceptualHash, long otherPerceptualHash) {
+        return Long.bitCount(perceptualHash ^ otherPerceptualHash);
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+}
@@ -1,5 +1,15 @@
 package org.libpag;
 
+/**
+ * The concurrency model of the layer bindings: a PAGLayer may be called from any thread. All layers
+ * of a layer tree and the PAGPlayer displaying it share a single lock in libpag, so calls on the
+ * same tree are serialized and always observe a consistent tree. A tree can be displayed by one
+ * PAGPlayer at a time, and its progress is shared by everything rendering it. To render the same
+ * file on several threads concurrently, at different times, give each thread its own copy from
+ * PAGFile.copyOriginal() or PAGFileInstancePool. The copies share the immutable parsed file data,
+ * only their layer objects and timeline state are separate, so they neither block each other nor
+ * duplicate the content of the file.
+ */
 public class PAGLayer {
     public static final int LayerTypeUnknown = 0;
     public static final int LayerTypeNull = 1;
@@ -145,8 +155,6 @@ public class PAGLayer {
 
     protected long nativeContext;
 
-    private static native void nativeInit();
-
     private native boolean nativeEquals(PAGLayer other);
 
     @Override
@@ -172,6 +180,5 @@ public class PAGLayer {
 
     static {
         LibraryLoadUtils.loadLibrary("pag4j");
-        nativeInit();
     }
 }
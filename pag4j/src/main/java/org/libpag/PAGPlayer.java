@@ -1,6 +1,19 @@
 package org.libpag;
 
 public class PAGPlayer {
+    /**
+     * flushScrub() did not render anything because the content has not changed.
+     */
+    public static final int ScrubStageNone = 0;
+    /**
+     * flushScrub() rendered a reduced quality preview because the progress is still changing.
+     */
+    public static final int ScrubStagePreview = 1;
+    /**
+     * flushScrub() rendered the frame in full quality.
+     */
+    public static final int ScrubStageRefined = 2;
+
     private PAGSurface pagSurface = null;
 
     public PAGPlayer() {
@@ -180,6 +193,102 @@ public class PAGPlayer {
      */
     public native boolean waitSync(long sync);
 
+    /**
+     * Enables or disables the scrub mode. While the progress keeps changing, flushScrub() renders
+     * with the cache scale multiplied by previewScale. Once the progress has not changed for
+     * settleMillis milliseconds, the next flushScrub() re-renders the settled frame in full quality.
+     */
+    public native void setScrubMode(boolean enabled, float previewScale, long settleMillis);
+
+    /**
+     * Returns true if the scrub mode is enabled.
+     */
+    public native boolean scrubMode();
+
+    /**
+     * Apply all pending changes to the target surface in scrub mode, or like flush() if the scrub
+     * mode is disabled. Returns the stage that was rendered, one of ScrubStageNone,
+     * ScrubStagePreview and ScrubStageRefined.
+     */
+    public native int flushScrub();
+
+    /**
+     * Returns the number of milliseconds after which flushScrub() should be called again to refine
+     * the last preview, or -1 if no preview is waiting to be refined.
+     */
+    public native long scrubRefineDelay();
+
+    /**
+     * Attaches the static frames of the player's PAGFile, or detaches them if null. While the
+     * progress stays within a run of frames that are duplicates of each other and nothing has been
+     * changed through the API since the last flush, flush() returns false without evaluating or
+     * drawing the composition. PAGFrameExporter reuses the previous encoded frame for duplicate
+     * frames as well. The static frames are ignored while the player shows another composition
+     * and for good once the file or any of its layers has been edited.
+     */
+    public native void setStaticFrames(PAGStaticFrames staticFrames);
+
+    /**
+     * Enables or disables the quality governor. When enabled, the player measures the duration of
+     * every flush and of the readbacks from its surface against the frame budget of
+     * targetFrameRate. It lowers the cache scale and then the maximum frame rate while frames exceed
+     * the budget, and restores them after frame times stay well below it. The values set by
+     * setCacheScale() and setMaxFrameRate() are the upper bounds it works within.
+     */
+    public native void setQualityGovernor(boolean enabled, float targetFrameRate);
+
+    /**
+     * Returns the current quality level of the governor, 0 is the full quality and higher levels
+     * render with lower quality.
+     */
+    public native int qualityLevel();
+
+    /**
+     * Returns the decisions and timings of the quality governor. The array must hold at least 5
+     * values: the average flush time in milliseconds, the average readback time in milliseconds,
+     * the cache scale in use, the maximum frame rate in use and the number of level changes.
+     */
+    public native void qualityStats(float[] values);
+
+    /**
+     * Enables the preroll of upcoming assets when lookaheadMillis is positive, or disables it.
+     * After every flush, the player looks for image layers and video or bitmap sequences that
+     * become visible within the next lookaheadMillis of the timeline and calls prepare() at their
+     * start time, so they are decoded in the background before the frame that first shows them.
+     * The estimated decoded size of the assets prerolled but not yet visible is kept below
+     * memoryBudget bytes. The lookahead follows the timeline and restarts when the progress loops
+     * or moves back.
+     */
+    public native void setPreroll(long lookaheadMillis, long memoryBudget);
+
+    /**
+     * Returns the results of the preroll. The array must hold at least 3 values: the number of
+     * prerolled assets, the number of assets that became visible without a preroll, such as when
+     * the lookahead was too short or the budget exhausted, and the estimated bytes of the assets
+     * prerolled but not yet visible.
+     */
+    public native void prerollStats(long[] values);
+
+    /**
+     * Enables or disables the eviction of decoded assets. Image layers and video or bitmap sequences
+     * are decoded when they are first drawn. When enabled, the player keeps track of them and, once
+     * most of the decoded memory belongs to assets the playhead has left by more than marginMillis,
+     * frees the caches of its surface right before a flush, so only the compressed data of these
+     * assets stays in memory. That flush decodes the visible assets again and redraws the frame,
+     * even within static frames. The default value is disabled.
+     */
+    public native void setAssetEviction(boolean enabled, long marginMillis);
+
+    /**
+     * Returns the decoded and total sizes of the assets tracked by the asset eviction, which are
+     * estimated from the bounds of their layers. If the file is not null, only the assets that
+     * belong to it directly are counted, not those of the PAGFiles nested in it. The array must
+     * hold at least 5 values: the resident bytes, the total bytes, the number of resident assets,
+     * the total number of assets and the number of times the caches were freed. Nothing is tracked
+     * while the asset eviction is disabled.
+     */
+    public native void assetStats(PAGFile file, long[] values);
+
     /**
      * Returns a rectangle in pixels that defines the displaying area of the specified layer, which
      * is in the coordinate of the PAGSurface.
@@ -197,6 +306,17 @@ public class PAGPlayer {
     public native boolean hitTestPoint(PAGLayer pagLayer, float surfaceX,
                                        float surfaceY, boolean pixelHitTest);
 
+    /**
+     * Renders the composition at the specified progress into a width x height thumbnail, scaled to
+     * fit with the LetterBox mode, and copies its pixels to the specified bitmap. Assets are drawn
+     * and cached at the thumbnail scale, and video compositions use their smallest sequence that
+     * covers it. The offscreen surface is reused by later calls of the same size on the same
+     * thread. The composition is removed from its previous PAGPlayer. Returns false if the
+     * thumbnail could not be rendered.
+     */
+    public static native boolean RenderThumbnail(PAGComposition composition, double progress,
+                                                 int width, int height, byte[] pixels, int stride);
+
     /**
      * Free up resources used by the PAGPlayer instance immediately instead of relying on the
      * garbage collector to do this for you at some point in the future.
@@ -215,12 +335,9 @@ public class PAGPlayer {
 
     private native final void nativeSetup();
 
-    private static native final void nativeInit();
-
     static {
         // LibraryLoadUtils.loadLibrary("ffavc");
         LibraryLoadUtils.loadLibrary("pag4j");
-        nativeInit();
     }
 
     private long nativeContext = 0;
@@ -0,0 +1,166 @@
+package org.libpag;
+
+import java.io.File;
+import java.io.IOException;
+
+/**
+ * A session with a pag4j-server process, which hosts a PAGPlayer and an offscreen PAGSurface
+ * outside of the JVM. A crash or stall of the native renderer then only ends the sessions of that
+ * process, and rendering can be spread over several server processes, each with its own sessions.
+ * Rendered frames are written by the server into a shared memory ring of slots, which is mapped
+ * into this process as well, so copySlotTo() copies the pixels straight from the shared memory
+ * into a Java array instead of receiving them over the socket. The mapping itself is never handed
+ * out, so releasing the client or setting up a new ring never invalidates memory Java still uses.
+ * The pixels are premultiplied RGBA.
+ * Note: The render server is not available on Windows, where Connect() always returns null.
+ */
+public class PAGRenderClient {
+    /**
+     * Starts a pag4j-server process listening on the socket path and waits until it accepts
+     * connections. The server only moves its socket to the path once it listens, so Connect()
+     * succeeds as soon as this returns. The server exits once the returned process' standard input
+     * is closed, which also happens when the JVM exits. Returns null if the server could not be
+     * started within the timeout.
+     */
+    public static Process StartServer(String executable, String socketPath, long timeoutMillis) {
+        if (executable == null || socketPath == null) {
+            return null;
+        }
+        File socketFile = new File(socketPath);
+        socketFile.delete();
+        Process process;
+        try {
+            process = new ProcessBuilder(executable, "--watch-stdin", socketPath)
+                    .redirectOutput(ProcessBuilder.Redirect.INHERIT)
+                    .redirectError(ProcessBuilder.Redirect.INHERIT)
+                    .start();
+        } catch (IOException e) {
+            e.printStackTrace();
+            return null;
+        }
+        long deadline = System.currentTimeMillis() + timeoutMillis;
+        while (!socketFile.exists()) {
+            if (!process.isAlive() || System.currentTimeMillis() > deadline) {
+                process.destroy();
+                return null;
+            }
+            try {
+                Thread.sleep(10);
+            } catch (InterruptedException e) {
+                process.destroy();
+                Thread.currentThread().interrupt();
+                return null;
+            }
+        }
+        return process;
+    }
+
+    /**
+     * Opens a new session with the server listening on the socket path. Returns null if no server
+     * accepts connections there.
+     */
+    public static PAGRenderClient Connect(String socketPath) {
+        if (socketPath == null) {
+            return null;
+        }
+        long nativeContext = ConnectClient(socketPath);
+        if (nativeContext == 0) {
+            return null;
+        }
+        return new PAGRenderClient(nativeContext);
+    }
+
+    private static native long ConnectClient(String socketPath);
+
+    private PAGRenderClient(long nativeContext) {
+        this.nativeContext = nativeContext;
+    }
+
+    /**
+     * Loads the PAG file at the path, which is resolved by the server process, and replaces the
+     * previously loaded one. Returns false if the file cannot be loaded or the session has ended.
+     */
+    public native boolean load(String path);
+
+    /**
+     * Loads a PAG file from its bytes, which are sent to the server, and replaces the previously
+     * loaded one. Returns false if the file cannot be loaded or the session has ended.
+     */
+    public native boolean loadData(byte[] bytes);
+
+    /**
+     * The width of the loaded file.
+     */
+    public native int width();
+
+    /**
+     * The height of the loaded file.
+     */
+    public native int height();
+
+    /**
+     * The duration of the loaded file in microseconds.
+     */
+    public native long duration();
+
+    /**
+     * The frame rate of the loaded file.
+     */
+    public native float frameRate();
+
+    /**
+     * The number of frames of the loaded file.
+     */
+    public native long numFrames();
+
+    /**
+     * Creates the shared memory ring with slotCount slots of the size, ranging from 1 to 16 slots,
+     * and the offscreen surface the server renders into, replacing the previous ring. Returns false
+     * if the ring cannot be created.
+     */
+    public native boolean setupRing(int width, int height, int slotCount);
+
+    /**
+     * Renders the frame of the loaded file into a free slot of the ring and returns the index of
+     * the slot, whose pixels stay unchanged until the slot is released. Returns -1 if every slot
+     * is still held, if no file or ring has been set up, or if the session has ended.
+     */
+    public native int renderFrame(long frame);
+
+    /**
+     * Copies the pixels of the slot to the specified bitmap, whose rows are stride bytes apart.
+     * The stride must be at least the width of the ring * 4. Returns false if the slot does not
+     * hold a rendered frame, the bitmap is too small, or no ring has been set up.
+     */
+    public native boolean copySlotTo(int slot, byte[] pixels, int stride);
+
+    /**
+     * Returns the frame rendered into the slot, or -1 if the slot does not hold a rendered frame.
+     */
+    public native long slotFrame(int slot);
+
+    /**
+     * Hands the slot back to the server, which may render into it again afterwards.
+     */
+    public native void releaseSlot(int slot);
+
+    /**
+     * Ends the session and unmaps the ring immediately instead of relying on the garbage collector
+     * to do this for you at some point in the future.
+     */
+    public void release() {
+        nativeRelease();
+    }
+
+    private native void nativeRelease();
+
+    protected void finalize() {
+        nativeRelease();
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private long nativeContext = 0;
+}
@@ -0,0 +1,73 @@
+package org.libpag;
+
+/**
+ * Renders a composition for timeline scrubbing with random access. The rendered frames are kept
+ * in a bounded LRU cache, and a native worker thread prefetches the frames ahead of the playhead
+ * in the current scrub direction, so that seeking backwards or far away in compositions with video
+ * sequences does not decode from the previous keyframe on every step.
+ * Note: The composition is rendered by the cache's own PAGPlayer, and it will be removed from its
+ * previous PAGPlayer. Each cached frame takes width * height * 4 bytes of memory.
+ */
+public class PAGSeekCache {
+
+    /**
+     * Creates a seek cache that renders the composition at the specified size and keeps at most
+     * capacity frames in memory. Returns null if the cache could not be created.
+     */
+    public static PAGSeekCache Make(PAGComposition composition, int width, int height, int capacity) {
+        long nativeContext = SetupCache(composition, width, height, capacity);
+        if (nativeContext == 0) {
+            return null;
+        }
+        return new PAGSeekCache(nativeContext);
+    }
+
+    private static native long SetupCache(PAGComposition composition, int width, int height,
+                                          int capacity);
+
+    private PAGSeekCache(long nativeContext) {
+        this.nativeContext = nativeContext;
+    }
+
+    /**
+     * The number of frames of the composition.
+     */
+    public native long numFrames();
+
+    /**
+     * Moves the playhead to the frame and copies its pixels to the specified bitmap, the frame is
+     * rendered synchronously if it is not cached yet. Returns false if the frame is out of range or
+     * could not be rendered.
+     */
+    public native boolean readFrame(long frame, byte[] pixels, int stride);
+
+    /**
+     * The number of readFrame() calls served from the cache.
+     */
+    public native long hitCount();
+
+    /**
+     * The number of readFrame() calls that had to render the frame.
+     */
+    public native long missCount();
+
+    /**
+     * Free up resources used by the PAGSeekCache instance immediately instead of relying on the
+     * garbage collector to do this for you at some point in the future.
+     */
+    public void release() {
+        nativeRelease();
+    }
+
+    private native void nativeRelease();
+
+    protected void finalize() {
+        nativeRelease();
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private long nativeContext = 0;
+}
@@ -0,0 +1,81 @@
+package org.libpag;
+
+/**
+ * A table of the frames of a PAGFile that render exactly the same content as the frame before
+ * them, such as holds between keyframes or static backgrounds. The table is built once by
+ * replaying every frame of the file on a small offscreen surface and recording whether libpag
+ * reports a change, which takes roughly as long as rendering all frames at a tiny size.
+ * Attach it to a PAGPlayer with PAGPlayer.setStaticFrames() to skip flushing duplicate frames,
+ * which also lets PAGFrameExporter reuse the previous encoded frame instead of rendering, reading
+ * back and encoding it again. The table is also useful to encoders that can emit duplicate-frame
+ * markers instead of full frames.
+ * Note: The analysis covers the original content of the file. Any edit to the file or its layers
+ * through the API, such as setStartTime(), setProgress() or setVisible() on a layer, replacing
+ * an image or adding the file to another composition, makes the table stale for good, and
+ * PAGPlayer and PAGFrameExporter stop using it. A file that has been edited before the analysis
+ * never uses the table. Analyze the file again after editing it to skip frames again.
+ */
+public class PAGStaticFrames {
+    /**
+     * Analyzes every frame of the file. Returns null if the file is null or the analysis failed.
+     */
+    public static PAGStaticFrames Analyze(PAGFile pagFile) {
+        if (pagFile == null) {
+            return null;
+        }
+        long nativeContext = AnalyzeFile(pagFile);
+        if (nativeContext == 0) {
+            return null;
+        }
+        return new PAGStaticFrames(nativeContext);
+    }
+
+    private static native long AnalyzeFile(PAGFile pagFile);
+
+    private PAGStaticFrames(long nativeContext) {
+        this.nativeContext = nativeContext;
+    }
+
+    /**
+     * Returns the number of analyzed frames.
+     */
+    public native long numFrames();
+
+    /**
+     * Returns the number of frames that are duplicates of the frame before them.
+     */
+    public native long numDuplicates();
+
+    /**
+     * Returns true if the frame renders the same content as the frame before it. The first frame
+     * is never a duplicate.
+     */
+    public native boolean isDuplicate(long frame);
+
+    /**
+     * Returns the duplicate flags of all frames as a bitmap, in which bit (N % 64) of element
+     * (N / 64) is set if frame N is a duplicate of frame N - 1.
+     */
+    public native long[] duplicateBits();
+
+    /**
+     * Free up resources used by the PAGStaticFrames instance immediately instead of relying on the
+     * garbage collector to do this for you at some point in the future. Players the table is
+     * attached to keep using it.
+     */
+    public void release() {
+        nativeRelease();
+    }
+
+    private native void nativeRelease();
+
+    protected void finalize() {
+        nativeRelease();
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private long nativeContext = 0;
+}
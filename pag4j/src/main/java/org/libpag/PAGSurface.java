@@ -1,7 +1,17 @@
 package org.libpag;
 
+import java.nio.ByteBuffer;
+
+/**
+ * Offscreen surfaces render through the GL device of libpag. On Linux, Mesa's llvmpipe rasterizer
+ * on a surfaceless EGL display needs no GPU or display server and rasterizes in tiles on
+ * LP_NUM_THREADS CPU cores. Select it by starting the JVM with LIBGL_ALWAYS_SOFTWARE=1,
+ * GALLIUM_DRIVER=llvmpipe and EGL_PLATFORM=surfaceless in its environment, and LP_NUM_THREADS set
+ * to the number of cores to use. The variables must be set at launch: the GL driver reads them
+ * once when the first surface is created, and pag4j never changes the environment of the running
+ * JVM, since setenv() is not safe while other threads may read the environment.
+ */
 public class PAGSurface {
-
     public static PAGSurface MakeOffscreen(int width, int height) {
         long nativeSurface = SetupOffscreen(width, height);
         if (nativeSurface == 0) {
@@ -12,7 +22,7 @@ public class PAGSurface {
 
     private static native long SetupOffscreen(int width, int height);
 
-    private PAGSurface(long nativeSurface) {
+    PAGSurface(long nativeSurface) {
         this.nativeSurface = nativeSurface;
     }
 
@@ -44,7 +54,51 @@ public class PAGSurface {
     /**
      * Copies pixels from current PAGSurface to the specified bitmap.
      */
-    public native boolean copyPixelsTo(byte[] pixels, int stride);
+    public boolean copyPixelsTo(byte[] pixels, int stride) {
+        return nativeCopyPixelsTo(pixels, stride, null);
+    }
+
+    /**
+     * Copies pixels from current PAGSurface to the specified bitmap and stores the fingerprint of
+     * the copied frame in the fingerprint array, see PAGFrameFingerprint. Index 0 receives the
+     * exact hash, index 1 the perceptual hash if the array has room for it, which costs a little
+     * more to compute.
+     */
+    public boolean copyPixelsTo(byte[] pixels, int stride, long[] fingerprint) {
+        return nativeCopyPixelsTo(pixels, stride, fingerprint);
+    }
+
+    private native boolean nativeCopyPixelsTo(byte[] pixels, int stride, long[] fingerprint);
+
+    /**
+     * Copies pixels from current PAGSurface to the specified direct buffer without any intermediate
+     * copy. Returns false if the buffer is not a direct buffer or is too small.
+     */
+    public boolean copyPixelsTo(ByteBuffer pixels, int stride) {
+        return copyPixelsTo(pixels, stride, null);
+    }
+
+    /**
+     * Copies pixels to the specified direct buffer like copyPixelsTo(ByteBuffer, int) and stores
+     * the fingerprint of the copied frame like copyPixelsTo(byte[], int, long[]).
+     */
+    public boolean copyPixelsTo(ByteBuffer pixels, int stride, long[] fingerprint) {
+        if (pixels == null || !pixels.isDirect()) {
+            return false;
+        }
+        return nativeCopyPixelsToBuffer(pixels, stride, fingerprint);
+    }
+
+    private native boolean nativeCopyPixelsToBuffer(ByteBuffer pixels, int stride,
+                                                    long[] fingerprint);
+
+    /**
+     * Copies only the pixels that changed since the previous call of this method to the specified
+     * bitmap, which must hold the result of that previous call. Returns the changed regions in
+     * pixels, an empty array if nothing has changed, or null if the pixels could not be read. The
+     * first call, and any call after the surface size changed, reports the whole surface.
+     */
+    public native PAGRect[] copyDirtyPixelsTo(byte[] pixels, int stride);
 
     /**
      * Free up resources used by the PAGSurface instance immediately instead of relying on the
@@ -59,8 +113,6 @@ public class PAGSurface {
 
     private native void nativeRelease();
 
-    private static native void nativeInit();
-
     private native void nativeFinalize();
 
     protected void finalize() {
@@ -69,7 +121,6 @@ public class PAGSurface {
 
     static {
         LibraryLoadUtils.loadLibrary("pag4j");
-        nativeInit();
     }
 
     long nativeSurface = 0;
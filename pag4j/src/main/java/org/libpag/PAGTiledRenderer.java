@@ -0,0 +1,88 @@
+package org.libpag;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Renders frames of any size, such as for print or 8K exports, which PAGSurface.MakeOffscreen()
+ * cannot allocate beyond the maximum texture size of the backend. The composition is rendered
+ * tile by tile into one offscreen surface of the tile size, and every finished row of tiles is
+ * streamed to a BandListener, so the memory used is bounded by one band of width x tileHeight
+ * pixels no matter how tall the frame is. The layer caches are disabled, since they would be
+ * rasterized at the full output scale.
+ */
+public class PAGTiledRenderer {
+    public interface BandListener {
+        /**
+         * Receives rows [top, top + rows) of the frame as premultiplied RGBA pixels with the stride
+         * of rowBytes. The buffer maps native memory that is reused for the next band, it must not
+         * be used after this call returns. Returns false to abort the rendering.
+         */
+        boolean onBand(ByteBuffer pixels, int top, int rows, int rowBytes);
+    }
+
+    /**
+     * Creates a renderer with tiles of the specified size, which must not exceed the maximum
+     * texture size. Larger tiles need fewer passes over the composition. Returns null if the tile
+     * surface cannot be created.
+     */
+    public static PAGTiledRenderer Make(int tileWidth, int tileHeight) {
+        long nativeContext = SetupRenderer(tileWidth, tileHeight);
+        if (nativeContext == 0) {
+            return null;
+        }
+        return new PAGTiledRenderer(nativeContext);
+    }
+
+    private static native long SetupRenderer(int tileWidth, int tileHeight);
+
+    private PAGTiledRenderer(long nativeContext) {
+        this.nativeContext = nativeContext;
+    }
+
+    /**
+     * The width of the tiles.
+     */
+    public native int tileWidth();
+
+    /**
+     * The height of the tiles, which is the number of rows per band.
+     */
+    public native int tileHeight();
+
+    /**
+     * Renders the composition at the progress into a width x height frame, placed by the scale
+     * mode like PAGPlayer does, and passes its bands to the listener from top to bottom. The
+     * composition is removed from the player it was attached to. Returns false if any tile failed
+     * to render or the listener aborted.
+     */
+    public boolean render(PAGComposition composition, double progress, int width, int height,
+                          int scaleMode, BandListener listener) {
+        if (composition == null || listener == null) {
+            return false;
+        }
+        return nativeRender(composition, progress, width, height, scaleMode, listener);
+    }
+
+    private native boolean nativeRender(PAGComposition composition, double progress, int width,
+                                        int height, int scaleMode, BandListener listener);
+
+    /**
+     * Free up resources used by the PAGTiledRenderer instance immediately instead of relying on
+     * the garbage collector to do this for you at some point in the future.
+     */
+    public void release() {
+        nativeRelease();
+    }
+
+    private native void nativeRelease();
+
+    protected void finalize() {
+        nativeRelease();
+    }
+
+    static {
+        LibraryLoadUtils.loadLibrary("pag4j");
+    }
+
+    private long nativeContext = 0;
+}